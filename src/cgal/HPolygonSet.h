@@ -3,6 +3,9 @@
 #include "Types.h"
 
 #include <CGAL/Boolean_set_operations_2.h>
+#ifdef TESSELLATOR_EPECK_POLYGON_SETS
+#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#endif
 
 namespace meshlib {
 namespace cgal {
@@ -16,8 +19,15 @@ using PolygonSet = CGAL::Polygon_set_2<K>;
 using Arrangement = PolygonSet::Arrangement_2;
 using Segment = PolygonSet::Arrangement_2::Traits_2::Segment_2;
 
+// Boolean operations need exact constructions. Filtered lazy exact
+// arithmetic is usually faster but requires GMP at build time.
+#ifdef TESSELLATOR_EPECK_POLYGON_SETS
+using PK = CGAL::Exact_predicates_exact_constructions_kernel;
+using PKType = PK::FT;
+#else
 using PKType = CGAL::Quotient<CGAL::MP_Float>;
 using PK = CGAL::Cartesian<PKType>;
+#endif
 using PolygonPK = CGAL::Polygon_2<PK>;
 
 Polygon buildPolygon(const std::initializer_list<Point2>);
@@ -72,8 +72,7 @@ Mesh repair(const Mesh& m)
         repairGroup(r.coordinates, r.groups[gId], m.coordinates, g);
     }
 
-    Cleaner::fuseCoords(r);
-    Cleaner::cleanCoords(r);
+    Cleaner::Pipeline().fuseCoords().cleanCoords().apply(r);
 
     return r;
 }
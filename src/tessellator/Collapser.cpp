@@ -16,12 +16,11 @@ Collapser::Collapser(const Mesh& in, int decimalPlaces)
 {
     mesh_ = in;
     double factor = std::pow(10.0, decimalPlaces);
-    for (auto& v : mesh_.coordinates) {
-        v = v.round(factor);
-    }
     
-    Cleaner::fuseCoords(mesh_);
-    Cleaner::cleanCoords(mesh_);
+    Cleaner::Pipeline()
+        .fuseLatticeCoords(Lattice{ decimalPlaces })
+        .cleanCoords()
+        .apply(mesh_);
     
     Cleaner::collapseCoordsInLineDegenerateTriangles(mesh_, 0.4 / (factor * factor));
     Cleaner::removeRepeatedElements(mesh_);
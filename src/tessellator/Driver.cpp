@@ -211,5 +211,19 @@ Filler Driver::dualFill(const std::vector<Priority>& groupPriorities) const
     };
 }
 
+std::pair<Filler, Filler> Driver::fillWithDual(const std::vector<Priority>& groupPriorities) const
+{
+    log("Building primal and dual fillers.", 1);
+    const auto dGrid{ GridTools{ originalGrid_ }.getExtendedDualGrid() };
+
+    return Filler::buildPrimalAndDual(
+        reduceGrid(vMesh_, originalGrid_),
+        reduceGrid(sMesh_, originalGrid_),
+        setGrid(vMesh_, dGrid),
+        setGrid(sMesh_, dGrid),
+        groupPriorities
+    );
+}
+
 }
 }
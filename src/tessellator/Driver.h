@@ -17,6 +17,9 @@ public:
         const std::vector<Priority>& groupPriorities = std::vector<Priority>()) const;
     filler::Filler dualFill(
         const std::vector<Priority>& groupPriorities = std::vector<Priority>()) const;
+    // Builds primal and dual fillers sharing their polyhedrons construction.
+    std::pair<filler::Filler, filler::Filler> fillWithDual(
+        const std::vector<Priority>& groupPriorities = std::vector<Priority>()) const;
 
 private:
     DriverOptions opts_;
@@ -77,8 +77,10 @@ Slicer::Slicer(const Mesh& input) :
             }
         );
     }
-    Cleaner::removeElementsWithCondition(mesh_, [](auto e) {return !e.isTriangle(); });
-    Cleaner::fuseCoords(mesh_);
+    Cleaner::Pipeline()
+        .removeElementsWithCondition([](auto e) {return !e.isTriangle(); })
+        .fuseCoords()
+        .apply(mesh_);
     meshTools::checkNoCellsAreCrossed(mesh_);
 }
 
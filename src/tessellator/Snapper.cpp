@@ -4,7 +4,14 @@
 #include "utils/Cleaner.h"
 #include "utils/MeshTools.h"
 #include "cgal/Manifolder.h"
-#include "Collapser.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#ifdef TESSELLATOR_EXECUTION_POLICIES
+#include <execution>
+#include <thread>
+#endif
 
 namespace meshlib {
 namespace tessellator {
@@ -18,163 +25,145 @@ Snapper::Snapper(const Mesh& mesh, const SnapperOptions& opts) :
         throw std::logic_error("Invalid relaxed length");
     }
     snap();
-    
-    mesh_ = Collapser{mesh_, 4}.getMesh();
-    
+    fuse();
+
     utils::meshTools::checkNoCellsAreCrossed(mesh_);
     utils::meshTools::checkNoNullAreasExist(mesh_);
 }
 
-std::pair<Coordinates, std::map<Coordinate, std::set<LinV>>> Snapper::buildListOfValidSolverPoints() const
-{
-    // Vertices
-    Coordinates v(8);
-    v[0] = VecD({ 0.0, 0.0, 0.0 });
-    v[1] = VecD({ 1.0, 0.0, 0.0 });
-    v[2] = VecD({ 1.0, 1.0, 0.0 });
-    v[3] = VecD({ 0.0, 1.0, 0.0 });
-    v[4] = VecD({ 0.0, 0.0, 1.0 });
-    v[5] = VecD({ 1.0, 0.0, 1.0 });
-    v[6] = VecD({ 1.0, 1.0, 1.0 });
-    v[7] = VecD({ 0.0, 1.0, 1.0 });
-
-    // Edges
-    std::vector<LinV> edges(12);
-    edges[0] = { v[0], v[1] };
-    edges[1] = { v[1], v[2] };
-    edges[2] = { v[2], v[3] };
-    edges[3] = { v[3], v[0] };
-    edges[4] = { v[0], v[4] };
-    edges[5] = { v[1], v[5] };
-    edges[6] = { v[2], v[6] };
-    edges[7] = { v[3], v[7] };
-    edges[8] = { v[4], v[5] };
-    edges[9] = { v[5], v[6] };
-    edges[10] = { v[6], v[7] };
-    edges[11] = { v[7], v[4] };
-
-    std::map<Coordinate, std::set<LinV>> coordsToEdge;
-
-    std::set<Coordinate> aux;
-    for (auto const& e : edges) {
-        const Coordinate& vIni = e[0];
-        aux.insert(vIni);
-        coordsToEdge[vIni].insert(e);
-        const Coordinate& vEnd = e[1];
-        aux.insert(vEnd);
-        coordsToEdge[vEnd].insert(e);
-
-        const Coordinate vRIni = vIni + (vEnd - vIni) * opts_.forbiddenLength;
-        aux.insert(vRIni);
-        coordsToEdge[vRIni].insert(e);
-        const Coordinate vREnd = vIni + (vEnd - vIni) * (1.0 - opts_.forbiddenLength);
-        aux.insert(vREnd);
-        coordsToEdge[vREnd].insert(e);
-
-        for (std::size_t i = 0; i < opts_.edgePoints; i++) {
-            const double t = double(i + 1) / double(opts_.edgePoints + 1);
-            const Coordinate inner = vRIni + (vREnd - vRIni) * t;
-            aux.insert(inner);
-            coordsToEdge[inner].insert(e);
+namespace {
 
-        }
-    }
+const int SNAPPED_DECIMAL_PLACES{ 4 };
 
-    return std::make_pair(Coordinates(aux.begin(), aux.end()), coordsToEdge);
-}
+struct CoordinatesChunk {
+    CoordinateId begin;
+    CoordinateId end;
+    std::vector<std::pair<SnapperTools::EdgeId, Coordinate>> snappedOnEdges;
+};
 
-bool edgeIsCandidate(
-    const LinV& edge,
-    const Relative& rel,
-    const utils::GridTools& gT)
+std::vector<CoordinatesChunk> buildCoordinatesChunks(std::size_t size)
 {
-    if (gT.isRelativeOnCellFace(rel)) {
-        const Axis& axis = gT.getCellFaceAxis(rel).second;
-        return !(edge[0][axis] == 1 || edge[1][axis] == 1);
+    std::size_t numberOfChunks{ 1 };
+#ifdef TESSELLATOR_EXECUTION_POLICIES
+    numberOfChunks = std::max(std::thread::hardware_concurrency(), 1u) * 4;
+#endif
+    const std::size_t chunkSize{ (size + numberOfChunks - 1) / numberOfChunks };
+    std::vector<CoordinatesChunk> res;
+    for (std::size_t begin = 0; begin < size; begin += chunkSize) {
+        res.push_back({ begin, std::min(begin + chunkSize, size), {} });
     }
-    return true;
+    return res;
 }
 
+}
 
 void Snapper::snap()
 {
-    Coordinates solverPoints;
-    std::map<Coordinate, std::set<LinV>> coordsToEdge;
-    std::tie(solverPoints, coordsToEdge) = buildListOfValidSolverPoints();
     // Snaps using closest point
-    utils::GridTools gT(mesh_.grid);
-    std::vector<Relative> r = mesh_.coordinates;
-
-    std::map<LinV, Coordinates> edgeToSnappedCoords;
-
-    for (std::size_t i = 0; i < r.size(); i++) {
-        Relative rel = r[i];
-        if (gT.isRelativeOnCellEdge(rel)) {
-            Coordinate closest, solverPoint;
-            std::tie(closest, solverPoint) = findClosestSolverPoint(rel, solverPoints, gT);
-
-            CoordinateId id = i;
-            r[id] = closest;
-
-            VecD cell = gT.toCell(rel).as<double>();
-            for (const auto& edge : coordsToEdge[solverPoint]) {
-                LinV l = { edge[0] + cell, edge[1] + cell };
-                edgeToSnappedCoords[l].push_back(closest);
+    const SnapperTools sT(mesh_.grid, opts_);
+    Coordinates& r = mesh_.coordinates;
+
+    // Coordinates on cell edges are snapped first, collecting them per chunk.
+    // Chunks are merged in order so that results do not depend on scheduling.
+    auto chunks{ buildCoordinatesChunks(r.size()) };
+    std::for_each(
+#ifdef TESSELLATOR_EXECUTION_POLICIES
+        std::execution::par,
+#endif
+        chunks.begin(), chunks.end(), [&](auto& chunk) {
+        for (CoordinateId id = chunk.begin; id < chunk.end; id++) {
+            const Relative& rel = r[id];
+            if (!sT.isRelativeOnCellEdge(rel)) {
+                continue;
+            }
+            const auto solverPoint{ sT.findClosestSolverPoint(rel) };
+            const Cell cell = sT.toCell(rel);
+            for (std::size_t e = 0; e < solverPoint.numberOfEdges; e++) {
+                chunk.snappedOnEdges.emplace_back(
+                    sT.getEdgeId(cell, solverPoint.edges[e]), solverPoint.position);
             }
+            r[id] = solverPoint.position;
         }
+    });
+
+    std::size_t numberOfSnapped{ 0 };
+    for (const auto& chunk : chunks) {
+        numberOfSnapped += chunk.snappedOnEdges.size();
+    }
+    std::unordered_map<SnapperTools::EdgeId, Coordinates> edgeToSnappedCoords;
+    edgeToSnappedCoords.reserve(numberOfSnapped);
+    for (auto& chunk : chunks) {
+        for (const auto& [edgeId, c] : chunk.snappedOnEdges) {
+            edgeToSnappedCoords[edgeId].push_back(c);
+        }
+        chunk.snappedOnEdges.clear();
     }
 
-    for (std::size_t i = 0; i < r.size(); i++) {
-        Relative rel = r[i];
-        if (!gT.isRelativeOnCellEdge(rel) && !gT.isRelativeOnCellCorner(rel)) {
-            Coordinate closest, solverPoint;
-            std::tie(closest, solverPoint) = findClosestSolverPoint(rel, solverPoints, gT);
+    // Remaining coordinates only read the edge table.
+    std::for_each(
+#ifdef TESSELLATOR_EXECUTION_POLICIES
+        std::execution::par,
+#endif
+        chunks.begin(), chunks.end(), [&](const auto& chunk) {
+        for (CoordinateId id = chunk.begin; id < chunk.end; id++) {
+            const Relative rel = r[id];
+            if (sT.isRelativeOnCellEdge(rel) || sT.isRelativeOnCellCorner(rel)) {
+                continue;
+            }
+            const auto solverPoint{ sT.findClosestSolverPoint(rel) };
+            Coordinate closest = solverPoint.position;
 
-            VecD cell = gT.toCell(r[i]).as<double>();
+            const Cell cell = sT.toCell(rel);
             double minDist = std::numeric_limits<double>::max();
-            for (const auto& edge : coordsToEdge[solverPoint]) {
-                if (edgeIsCandidate(edge, rel, gT)) {
-                    LinV l = { edge[0] + cell, edge[1] + cell };
-                    for (const auto& c : edgeToSnappedCoords[l]) {
-                        double dist = (gT.getPos(rel) - gT.getPos(c)).norm();
-                        if (dist < minDist) {
-                            minDist = dist;
-                            closest = c;
-                        }
+            for (std::size_t e = 0; e < solverPoint.numberOfEdges; e++) {
+                const auto& edge = solverPoint.edges[e];
+                if (!sT.isEdgeCandidate(edge, rel)) {
+                    continue;
+                }
+                auto it{ edgeToSnappedCoords.find(sT.getEdgeId(cell, edge)) };
+                if (it == edgeToSnappedCoords.end()) {
+                    continue;
+                }
+                for (const auto& c : it->second) {
+                    double dist = (sT.getPos(rel) - sT.getPos(c)).norm();
+                    if (dist < minDist) {
+                        minDist = dist;
+                        closest = c;
                     }
                 }
             }
-            CoordinateId id = i;
             r[id] = closest;
         }
-    }
-
-    mesh_.coordinates = r;
-
- }
+    });
+}
 
-std::pair<Coordinate, Coordinate> Snapper::findClosestSolverPoint(
-    const Relative& rel,
-    const Coordinates& solverPoints,
-    const utils::GridTools& gT) const
+void Snapper::fuse()
 {
-    Coordinate closest;
-    double minDist = std::numeric_limits<double>::max();
-    std::size_t minEdge = 0;
-    Coordinate pos = gT.getPos(rel);
-    for (std::size_t j = 0; j < solverPoints.size(); j++) {
-        Relative cellGridPoint = solverPoints[j] + gT.toCell(rel).as<double>();
-        double dist = (pos - gT.getPos(cellGridPoint)).norm();
-        if (dist < minDist) {
-            minDist = dist;
-            closest = cellGridPoint;
-            minEdge = j;
+    // Snapped coordinates lie on a finite set of solver points per cell, so
+    // they are fused by their quantized position instead of by a Collapser.
+    const double factor{ std::pow(10.0, SNAPPED_DECIMAL_PLACES) };
+    Coordinates& cs = mesh_.coordinates;
+
+    utils::Cleaner::Pipeline()
+        .fuseLatticeCoords(utils::Lattice{ SNAPPED_DECIMAL_PLACES })
+        .cleanCoords()
+        .apply(mesh_);
+
+    const double areaThreshold{ 0.4 / (factor * factor) };
+    bool degenerateTrianglesExist{ false };
+    for (const auto& g : mesh_.groups) {
+        for (const auto& e : g.elements) {
+            if (e.isTriangle() &&
+                utils::Geometry::isDegenerate(utils::Geometry::asTriV(e, cs), areaThreshold)) {
+                degenerateTrianglesExist = true;
+            }
         }
     }
-    return std::make_pair(closest, solverPoints[minEdge]);
+    if (degenerateTrianglesExist) {
+        utils::Cleaner::collapseCoordsInLineDegenerateTriangles(mesh_, areaThreshold);
+    }
+    utils::Cleaner::removeRepeatedElements(mesh_);
 }
 
-
-
 }
 }
\ No newline at end of file
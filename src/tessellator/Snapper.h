@@ -1,7 +1,7 @@
 #pragma once
 
 #include "types/Mesh.h"
-#include "utils/GridTools.h"
+#include "SnapperTools.h"
 #include "SnapperOptions.h"
 
 namespace meshlib {
@@ -24,15 +24,8 @@ private:
 	Mesh mesh_;
 	SnapperOptions opts_;
 
-	std::pair<Coordinate, Coordinate> findClosestSolverPoint(
-		const Relative& rel,
-		const Coordinates& solverPoints,
-		const utils::GridTools& gT) const;
-
-	std::pair<Coordinates, std::map<Coordinate, std::set<LinV>>> buildListOfValidSolverPoints() const;
-
-
 	void snap();
+	void fuse();
 };
 
 }
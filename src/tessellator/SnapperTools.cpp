@@ -0,0 +1,206 @@
+#include "SnapperTools.h"
+
+#include <algorithm>
+#include <set>
+
+namespace meshlib {
+namespace tessellator {
+
+using namespace utils;
+
+SnapperTools::SnapperTools(const Grid& grid, const SnapperOptions& opts) :
+    GridTools(grid)
+{
+    // Vertices
+    std::array<Cell, 8> v;
+    v[0] = Cell({ 0, 0, 0 });
+    v[1] = Cell({ 1, 0, 0 });
+    v[2] = Cell({ 1, 1, 0 });
+    v[3] = Cell({ 0, 1, 0 });
+    v[4] = Cell({ 0, 0, 1 });
+    v[5] = Cell({ 1, 0, 1 });
+    v[6] = Cell({ 1, 1, 1 });
+    v[7] = Cell({ 0, 1, 1 });
+
+    // Edges
+    cellEdges_[0] = { v[0], v[1] };
+    cellEdges_[1] = { v[1], v[2] };
+    cellEdges_[2] = { v[2], v[3] };
+    cellEdges_[3] = { v[3], v[0] };
+    cellEdges_[4] = { v[0], v[4] };
+    cellEdges_[5] = { v[1], v[5] };
+    cellEdges_[6] = { v[2], v[6] };
+    cellEdges_[7] = { v[3], v[7] };
+    cellEdges_[8] = { v[4], v[5] };
+    cellEdges_[9] = { v[5], v[6] };
+    cellEdges_[10] = { v[6], v[7] };
+    cellEdges_[11] = { v[7], v[4] };
+
+    std::array<std::vector<LocalEdge>, 8> onCorner;
+    for (LocalEdge e = 0; e < cellEdges_.size(); e++) {
+        const auto& edge = cellEdges_[e];
+        for (Axis a = 0; a < 3; a++) {
+            if (edge[0][a] != edge[1][a]) {
+                edgeAxis_[e] = a;
+                edgeIsReversed_[e] = edge[1][a] < edge[0][a];
+            }
+        }
+        for (const auto& c : edge) {
+            onCorner[c[X] + 2 * c[Y] + 4 * c[Z]].push_back(e);
+        }
+    }
+    for (std::size_t c = 0; c < onCorner.size(); c++) {
+        auto& edges = onCorner[c];
+        std::sort(edges.begin(), edges.end(),
+            [&](const LocalEdge& lhs, const LocalEdge& rhs) {
+                return cellEdges_[lhs] < cellEdges_[rhs];
+            }
+        );
+        assert(edges.size() == 3);
+        std::copy(edges.begin(), edges.end(), edgesOnCorner_[c].begin());
+    }
+
+    // Edges start in corners from -1 to numCells + 1 along each axis.
+    const Cell n{ numCells() };
+    strides_[Z] = 1;
+    strides_[Y] = strides_[Z] * (n[Z] + 3);
+    strides_[X] = strides_[Y] * (n[Y] + 3);
+
+    // Solver points lie at these parameters of every cell edge. They are
+    // evaluated from the edge origin so that reversed edges get exactly
+    // the same rounding as when interpolating their end points.
+    for (std::size_t r = 0; r < 2; r++) {
+        const RelativeDir vIni{ r == 0 ? 0.0 : 1.0 };
+        const RelativeDir vEnd{ r == 0 ? 1.0 : 0.0 };
+        const RelativeDir vRIni{ vIni + (vEnd - vIni) * opts.forbiddenLength };
+        const RelativeDir vREnd{ vIni + (vEnd - vIni) * (1.0 - opts.forbiddenLength) };
+        std::set<RelativeDir> params{ vIni, vRIni, vREnd, vEnd };
+        for (std::size_t i = 0; i < opts.edgePoints; i++) {
+            const double t = double(i + 1) / double(opts.edgePoints + 1);
+            params.insert(vRIni + (vREnd - vRIni) * t);
+        }
+        params_[r].assign(params.begin(), params.end());
+    }
+}
+
+SnapperTools::EdgeId SnapperTools::getEdgeId(
+    const Cell& cell,
+    const LocalEdge& e) const
+{
+    // Edges are oriented as in the cell edges table, so the same edge
+    // seen from two cells may get two different ids.
+    const Cell ini{ cell + cellEdges_[e][0] };
+    const Cell end{ cell + cellEdges_[e][1] };
+    EdgeId res = 0;
+    EdgeId direction = 0;
+    for (Axis d = 0; d < 3; d++) {
+        assert(ini[d] >= -1);
+        res += EdgeId(ini[d] + 1) * strides_[d];
+        if (ini[d] != end[d]) {
+            direction = 2 * d + (end[d] < ini[d] ? 1 : 0);
+        }
+    }
+    return res * 6 + direction;
+}
+
+bool SnapperTools::isEdgeCandidate(
+    const LocalEdge& e,
+    const Relative& rel) const
+{
+    if (isRelativeOnCellFace(rel)) {
+        const Axis& axis = getCellFaceAxis(rel).second;
+        const auto& edge = cellEdges_[e];
+        return !(edge[0][axis] == 1 || edge[1][axis] == 1);
+    }
+    return true;
+}
+
+SnapperTools::ParameterRange SnapperTools::findClosestEdgeParameters(
+    const std::vector<RelativeDir>& params,
+    const RelativeDir& cell,
+    const RelativeDir& rel,
+    const Axis& d) const
+{
+    // All parameters are equally close when the cell is degenerate.
+    if (getStepDir(toCellDir(cell), d) == 0.0) {
+        return { 0, 1 };
+    }
+    const std::size_t next = std::lower_bound(
+        params.begin(), params.end(), rel - cell) - params.begin();
+    if (next == 0) {
+        return { 0, 1 };
+    }
+    if (next == params.size()) {
+        return { next - 1, next };
+    }
+    return { next - 1, next + 1 };
+}
+
+SnapperTools::SolverPoint SnapperTools::findClosestSolverPoint(
+    const Relative& rel) const
+{
+    const Relative cell{ toCell(rel).as<double>() };
+    const Coordinate pos{ getPos(rel) };
+
+    std::array<std::array<ParameterRange, 2>, 3> ranges;
+    std::array<std::array<Coordinate, 2>, 3> paramDiffs;
+    std::array<Coordinate, 2> boundDiffs;
+    for (Axis d = 0; d < 3; d++) {
+        for (std::size_t r = 0; r < 2; r++) {
+            const auto& params = params_[r];
+            auto& range = ranges[d][r];
+            range = findClosestEdgeParameters(params, cell[d], rel[d], d);
+            for (std::size_t i = range.first; i < range.second; i++) {
+                paramDiffs[d][r][i - range.first] =
+                    pos[d] - getPosDir(params[i] + cell[d], d);
+            }
+        }
+        boundDiffs[0][d] = pos[d] - getPosDir(0.0 + cell[d], d);
+        boundDiffs[1][d] = pos[d] - getPosDir(1.0 + cell[d], d);
+    }
+
+    // Each edge is a segment of the cell, so only the solver points
+    // next to the projection on it can be the closest ones.
+    LocalEdge minEdge = 0;
+    Relative minLocal;
+    double minDist = std::numeric_limits<double>::max();
+    for (LocalEdge e = 0; e < cellEdges_.size(); e++) {
+        const Axis& a = edgeAxis_[e];
+        const std::size_t r = edgeIsReversed_[e] ? 1 : 0;
+        const Cell& origin = cellEdges_[e][0];
+        Relative local;
+        Coordinate diff;
+        for (Axis d = 0; d < 3; d++) {
+            local[d] = origin[d];
+            diff[d] = boundDiffs[origin[d]][d];
+        }
+        const auto& range = ranges[a][r];
+        for (std::size_t i = range.first; i < range.second; i++) {
+            local[a] = params_[r][i];
+            diff[a] = paramDiffs[a][r][i - range.first];
+            const double dist = diff.norm();
+            if (dist < minDist || (dist == minDist && local < minLocal)) {
+                minDist = dist;
+                minLocal = local;
+                minEdge = e;
+            }
+        }
+    }
+
+    SolverPoint res;
+    res.position = minLocal + cell;
+    const RelativeDir& param = minLocal[edgeAxis_[minEdge]];
+    if (param == 0.0 || param == 1.0) {
+        const Cell corner{ minLocal.as<int>() };
+        res.edges = edgesOnCorner_[corner[X] + 2 * corner[Y] + 4 * corner[Z]];
+        res.numberOfEdges = 3;
+    }
+    else {
+        res.edges[0] = minEdge;
+        res.numberOfEdges = 1;
+    }
+    return res;
+}
+
+}
+}
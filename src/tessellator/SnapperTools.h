@@ -0,0 +1,48 @@
+#pragma once
+
+#include "utils/GridTools.h"
+#include "SnapperOptions.h"
+
+namespace meshlib {
+namespace tessellator {
+
+class SnapperTools : public utils::GridTools {
+public:
+    using LocalEdge = std::size_t;
+    using EdgeId = std::size_t;
+
+    struct SolverPoint {
+        Relative position;
+        // Cell edges containing the point: three for corners, one otherwise.
+        std::array<LocalEdge, 3> edges;
+        std::size_t numberOfEdges;
+    };
+
+    SnapperTools(const Grid& grid, const SnapperOptions& opts = SnapperOptions());
+
+    SolverPoint findClosestSolverPoint(const Relative&) const;
+
+    EdgeId getEdgeId(const Cell&, const LocalEdge&) const;
+    bool isEdgeCandidate(const LocalEdge&, const Relative&) const;
+
+private:
+    using CellEdge = std::array<Cell, 2>;
+
+    std::array<CellEdge, 12> cellEdges_;
+    std::array<Axis, 12> edgeAxis_;
+    std::array<bool, 12> edgeIsReversed_;
+    std::array<std::array<LocalEdge, 3>, 8> edgesOnCorner_;
+    std::array<EdgeId, 3> strides_;
+
+    // Solver point parameters along edges oriented as the axis and reversed.
+    std::array<std::vector<RelativeDir>, 2> params_;
+
+    using ParameterRange = std::pair<std::size_t, std::size_t>;
+    ParameterRange findClosestEdgeParameters(
+        const std::vector<RelativeDir>& params,
+        const RelativeDir& cell, const RelativeDir& rel,
+        const Axis&) const;
+};
+
+}
+}
@@ -9,14 +9,16 @@
 #include "cgal/Manifolder.h"
 
 #include "utils/MeshTools.h"
+#include "utils/Cleaner.h"
 
-#include <CGAL/AABB_tree.h>
-#include <CGAL/AABB_traits.h>
-#include <CGAL/AABB_face_graph_triangle_primitive.h>
-#include <CGAL/Polygon_mesh_slicer.h>
+#include "SweepSlicer.h"
+#include "FillerFile.h"
 
 #include <CGAL/Polygon_mesh_processing/orientation.h>
 
+#include <exception>
+#include <thread>
+
 namespace meshlib {
 namespace tessellator {
 namespace filler {
@@ -26,21 +28,15 @@ using namespace polyhedronTools;
 using namespace tools;
 namespace PMP = CGAL::Polygon_mesh_processing;
 
-using Primitive = CGAL::AABB_face_graph_triangle_primitive<Polyhedron>;
-using Traits = CGAL::AABB_traits<K, Primitive>;
-using LineIntersectionsTree = CGAL::AABB_tree<Traits> ;
-using LineE3_intersection = boost::optional< LineIntersectionsTree::Intersection_and_primitive_id<Line3>::Type > ;
-
-using HGSP = CGAL::AABB_halfedge_graph_segment_primitive<Polyhedron>;
-using AABB_traits = CGAL::AABB_traits<K, HGSP>;
-using PMSlicerTree = CGAL::AABB_tree<AABB_traits>;
-using PMSlicer = CGAL::Polygon_mesh_slicer<Polyhedron, K>;
-
 enum class SlicingMode {
 	Surface,
 	Volume
 };
 
+using GridPlanesPolylines = std::array<std::map<SliceNumber, Polylines2>, 3>;
+using GridPlanesPolygons = std::array<std::map<SliceNumber, HPolygonSet>, 3>;
+using GridLinesPieces = std::array<std::map<ArrayIndex, std::set<Segment1>>, 3>;
+
 void log(const std::string& msg, std::size_t level = 0)
 {
 	std::cout << "[Filler] ";
@@ -57,21 +53,6 @@ struct FillerPolyhedrons {
 	Polyhedron aligned;
 };
 
-Plane3 buildSlicingPlane(const Axis& axis, const Height& offset) 
-{
-	switch (axis)
-	{
-	case X:
-		return Plane3(1.0, 0.0, 0.0, -offset);
-	case Y:
-		return Plane3(0.0, 1.0, 0.0, -offset);
-	case Z:
-		return Plane3(0.0, 0.0, 1.0, -offset);
-	default:
-		throw std::runtime_error("Invalid axis building plane");
-	}
-}
-
 Polyline2 convertPolyline3ToPolyline2(const Polyline3& pl, const Axis& x)
 {
 	Polyline2 pg;
@@ -98,51 +79,49 @@ Polyline2 convertPolyline3ToPolyline2(const Polyline3& pl, const Axis& x)
 	return pg;
 }
 
-std::array<std::map<SliceNumber, Polylines2>, 3> 
-buildGridPlanesPolylines(const Polyhedron& m, const Grid& g)
+GridPlanesPolylines buildGridPlanesPolylines(const Polyhedron& m, const Grid& g)
 {
-	std::array<std::map<SliceNumber, Polylines2>, 3> res;
+	GridPlanesPolylines res;
 	
 	if (m.empty()) {
 		return res;
 	}
 
-	PMSlicerTree tree{ edges(m).first, edges(m).second, m };
-	PMSlicer slicer(m, tree);
+	Mesh mesh{ buildMeshFromPolyhedron(m) };
+	mesh.grid = g;
+	utils::Cleaner::fuseCoords(mesh);
 
-	const std::array<Axis, 3> axis{ X, Y, Z };
-
-	std::for_each(
-#ifdef TESSELLATOR_EXECUTION_POLICIES
-		std::execution::par,
-#endif
-		axis.begin(), axis.end(),
-		[&](const auto& x) {
-			for (std::size_t i{ 0 }; i < g[x].size(); ++i) {
-				Polylines3 pl3s;
-				slicer(buildSlicingPlane(x, (Height)i), std::back_inserter(pl3s));
-				for (const auto& pl3 : pl3s) {
-					auto pl{ removeCollinears(convertPolyline3ToPolyline2(pl3, x)) };
-					if (pl.size() < 2) {
-						continue;
-					}
-					res[x][(int)i].push_back(pl);
+	const auto planesPolylines{ SweepSlicer{ mesh }.getPolylines() };
+	for (const auto& x : { X, Y, Z }) {
+		for (const auto& [i, pls] : planesPolylines[x]) {
+			for (const auto& cs : pls) {
+				Polyline3 pl3;
+				pl3.reserve(cs.size());
+				for (const auto& c : cs) {
+					pl3.push_back(Point3(c[X], c[Y], c[Z]));
 				}
+				auto pl{ removeCollinears(convertPolyline3ToPolyline2(pl3, x)) };
+				if (pl.size() < 2) {
+					continue;
+				}
+				res[x][i].push_back(pl);
 			}
 		}
-	);
-	
+	}
 	return res;
 }
 
+bool isInSlices(const Filler::Slices& slices, const SliceNumber& i)
+{
+	return i >= 0 && i < (SliceNumber)slices.size();
+}
+
 void sliceNonAlignedByGrid(
 	Filler::GridSlices& slices,
-	const Polyhedron& m, 
-	const Grid& g, 
+	const GridPlanesPolylines& polyLines,
 	const Priority& priority,
 	const SlicingMode mode)
 {
-	const auto polyLines{ buildGridPlanesPolylines(m, g) };
 	const std::array<Axis, 3> axis{ X, Y, Z };
 
 	std::for_each(
@@ -152,6 +131,9 @@ void sliceNonAlignedByGrid(
 		axis.begin(), axis.end(),
 		[&](const auto& x) {
 			for (const auto& [i, lines] : polyLines[x]) {
+				if (!isInSlices(slices[x], i)) {
+					continue;
+				}
 				if (mode == SlicingMode::Surface) {
 					slices[x][i].add(lines, priority);
 				}
@@ -174,10 +156,9 @@ Polygon buildPolygonFromFace(const Polyhedron::Facet& f, const Axis& x)
 	return res;
 }
 
-std::array<std::map<SliceNumber, HPolygonSet>, 3>
-buildGridPlanesPolygons(const Polyhedron& m, const Grid& g)
+GridPlanesPolygons buildGridPlanesPolygons(const Polyhedron& m, const Grid& g)
 {
-	std::array<std::map<SliceNumber, HPolygonSet>, 3> res;
+	GridPlanesPolygons res;
 	if (m.empty()) {
 		return res;
 	}
@@ -234,12 +215,9 @@ Polyhedron makeFacesCCWOriented(const Polyhedron& sm)
 
 void sliceAlignedByGrid(
 	Filler::GridSlices& slices,
-	const Polyhedron& m,
-	const Grid& g,
+	const GridPlanesPolygons& polygons,
 	const Priority& priority)
 {
-	
-	auto polygons{ buildGridPlanesPolygons(makeFacesCCWOriented(m), g)};
 	const std::array<Axis, 3> axis{ X, Y, Z };
 
 	std::for_each(
@@ -249,6 +227,9 @@ void sliceAlignedByGrid(
 		axis.begin(), axis.end(),
 		[&](const auto& x) {
 			for (const auto& [i, polygon] : polygons[x]) {
+				if (!isInSlices(slices[x], i)) {
+					continue;
+				}
 				slices[x][i].add(polygon, priority);
 			}
 		}
@@ -269,123 +250,195 @@ Priority Filler::getGroupPriority(const GroupId& gId) const
 void mergeGridSliceLines(Filler::GridSlices& rhs, const Filler::GridSlices& lhs)
 {
 	for (const auto& x : {X, Y, Z}) {
-		for (const auto& [num, slice]: lhs[x]) {
-			rhs[x][num].mergeLines(slice);
-			
+		for (std::size_t i{ 0 }; i < lhs[x].size(); ++i) {
+			rhs[x][i].mergeLines(lhs[x][i]);
 		}
 	}
 }
 
-Line3 buildLineQuery(const ArrayIndex& ij, const Axis& x)
+bool isOnGridLine(const KType& c)
 {
-	VecD ini, end;
-	ini(x) = 0.0;
-	ini[(x + 1) % 3] = (double) ij[0];
-	ini[(x + 2) % 3] = (double) ij[1];
-	end = ini;
-	end(x) = (double) 1.0;
-	
-	return {
-		Point3{ini[X], ini[Y], ini[Z]},
-		Point3{end[X], end[Y], end[Z]},
-	};
+	return std::floor(c) == c;
 }
 
-Segments1 convertToSegments1(const std::list<LineE3_intersection>& inters, const Axis& x)
+void addGridLinePiece(
+	GridLinesPieces& pieces,
+	const Grid& g,
+	const Axis& x,
+	const ArrayIndex& ij,
+	const Point1& ini,
+	const Point1& end)
 {
-	if (inters.empty()) {
-		return Segments1();
+	if (ini == end) {
+		return;
+	}
+	if (ij[0] < 0 || ij[0] >= (CellDir)g[(x + 1) % 3].size() ||
+		ij[1] < 0 || ij[1] >= (CellDir)g[(x + 2) % 3].size()) {
+		return;
 	}
+	pieces[x][ij].insert(Segment1{ std::min(ini, end), std::max(ini, end) });
+}
 
-	std::set<Segment1> segs;
-	for (auto it = inters.begin(); it != inters.end(); ++it) {		
-		if (const auto& e = boost::get<Segment3>(&((*it)->first))) {
-			segs.insert(
-				Segment1{ 
-					Point1{(*e)[0][(int)x]},
-					Point1{(*e)[1][(int)x]}
+GridLinesPieces buildGridLinesPieces(const GridPlanesPolylines& planes, const Grid& g)
+{
+	// Polyline segments lying on a grid line of the slicing plane are the 
+	// pieces of that line contained in the polyhedron surface.
+	GridLinesPieces res;
+	for (const auto& x : { X, Y, Z }) {
+		const auto y{ (x + 1) % 3 };
+		const auto z{ (x + 2) % 3 };
+		for (const auto& [n, pls] : planes[x]) {
+			for (const auto& pl : pls) {
+				for (auto it{ pl.begin() }; std::next(it) != pl.end(); ++it) {
+					const Point2& p{ *it };
+					const Point2& q{ *std::next(it) };
+					if (p.x() == q.x() && isOnGridLine(p.x())) {
+						addGridLinePiece(res, g, z, { n, (CellDir)p.x() }, p.y(), q.y());
+					}
+					else if (p.y() == q.y() && isOnGridLine(p.y())) {
+						addGridLinePiece(res, g, y, { (CellDir)p.y(), n }, p.x(), q.x());
+					}
 				}
-			);
+			}
 		}
 	}
+	return res;
+}
 
+GridLinesPieces buildGridLinesPieces(const GridPlanesPolygons& planes, const Grid& g)
+{
+	// Grid lines of each plane are scanned against the polygon edges. Pieces
+	// are the intervals between crossings plus the edges lying on the line.
+	GridLinesPieces res;
+	for (const auto& x : { X, Y, Z }) {
+		const std::array<Axis, 2> lineAxis{ (x + 2) % 3, (x + 1) % 3 };
+		for (const auto& [n, polygonSet] : planes[x]) {
+			std::vector<Segment2> edges;
+			for (const auto& pwh : polygonSet.getPolygonsWithHoles()) {
+				edges.insert(edges.end(),
+					pwh.outer_boundary().edges_begin(), pwh.outer_boundary().edges_end());
+				for (const auto& h : pwh.holes()) {
+					edges.insert(edges.end(), h.edges_begin(), h.edges_end());
+				}
+			}
+			if (edges.empty()) {
+				continue;
+			}
+
+			CGAL::Bbox_2 bbox;
+			for (const auto& e : edges) {
+				bbox += e.bbox();
+			}
+			for (int c{ 0 }; c < 2; ++c) {
+				const int o{ 1 - c };
+				for (auto h{ (CellDir)std::ceil(bbox.min(c)) }; h <= (CellDir)std::floor(bbox.max(c)); ++h) {
+					const ArrayIndex ij{ c == 0 ? ArrayIndex{ n, h } : ArrayIndex{ h, n } };
+					std::vector<Point1> crossings;
+					for (const auto& e : edges) {
+						const Point2& p{ e.source() };
+						const Point2& q{ e.target() };
+						if (p.cartesian(c) == h && q.cartesian(c) == h) {
+							addGridLinePiece(res, g, lineAxis[c], ij, p.cartesian(o), q.cartesian(o));
+						}
+						else if ((p.cartesian(c) > h) != (q.cartesian(c) > h)) {
+							const KType t{ (h - p.cartesian(c)) / (q.cartesian(c) - p.cartesian(c)) };
+							crossings.push_back(p.cartesian(o) + t * (q.cartesian(o) - p.cartesian(o)));
+						}
+					}
+					std::sort(crossings.begin(), crossings.end());
+					for (std::size_t i{ 0 }; i + 1 < crossings.size(); i += 2) {
+						addGridLinePiece(res, g, lineAxis[c], ij, crossings[i], crossings[i + 1]);
+					}
+				}
+			}
+		}
+	}
+	return res;
+}
+
+Segments1 mergeSegments1(const std::set<Segment1>& segs)
+{
 	Segments1 res;
 	res.reserve(segs.size());
 	for (const auto& seg : segs) {
-		if (res.empty()) {
-			res.push_back(seg);
+		if (!res.empty() && seg[0] <= res.back()[1]) {
+			res.back()[1] = std::max(res.back()[1], seg[1]);
 		}
-		if (res.back()[1] == seg[0]) {
-			res.back()[1] = seg[1];
+		else {
+			res.push_back(seg);
 		}
 	}
-	
 	return res;
 }
 
 void buildSegmentsArray(
 	Filler::GridSegmentsArray& arr,
-	const Polyhedron& p,
-	const Grid& g,
+	const GridLinesPieces& pieces,
 	const Priority& pr)
 {
-	LineIntersectionsTree tree{ faces(p).first, faces(p).second, p };
-
 	for (const auto& x : { X, Y, Z }) {
-		const auto y{ (x + 1) % 3 };
-		const auto z{ (x + 2) % 3 };
-		for (auto i{ 0 }; i < g[y].size(); ++i) {
-			for (auto j{ 0 }; j < g[z].size(); ++j) {
-				const ArrayIndex ij{ i,j };
-				std::list<LineE3_intersection> intersections;
-				tree.all_intersections(
-					buildLineQuery(ij, x), 
-					std::back_inserter(intersections)
-				);
-				const auto newSegs{convertToSegments1(intersections, x)};
-				if (!newSegs.empty()) {
-					auto& segmentsInPlace{ arr[x][ij] };
-					segmentsInPlace.add(pr, newSegs);
-				}
+		for (const auto& [ij, segs] : pieces[x]) {
+			arr[x][ij].add(pr, mergeSegments1(segs));
+		}
+	}
+}
+
+struct GroupSlices {
+	GridPlanesPolylines volumes;
+	GridPlanesPolylines surfaces;
+	GridPlanesPolygons aligned;
+	GridLinesPieces alignedPieces;
+	GridLinesPieces volumePieces;
+};
 
+GroupSlices buildGroupSlices(const FillerPolyhedrons& fP, const Grid& grid)
+{
+	GroupSlices res;
+	res.volumes = buildGridPlanesPolylines(fP.volumes, grid);
+	res.surfaces = buildGridPlanesPolylines(fP.surfaces, grid);
+	res.aligned = buildGridPlanesPolygons(makeFacesCCWOriented(fP.aligned), grid);
+	res.alignedPieces = buildGridLinesPieces(res.aligned, grid);
+	res.volumePieces = buildGridLinesPieces(res.volumes, grid);
+	return res;
+}
+
+void buildLengthFractions(Filler::GridSegmentsArray& arr)
+{
+	std::for_each(
+#ifdef TESSELLATOR_EXECUTION_POLICIES
+		std::execution::par,
+#endif
+		arr.begin(), arr.end(),
+		[&](auto& axis) {
+			for (auto& [ij, segs] : axis) {
+				segs.buildLengthFractions();
 			}
 		}
-	}
+	);
 }
 
 void buildGridSlicesSearchMaps(Filler::GridSlices& gS)
 {
-	log("Simplifying surface slices", 3);
-	for (auto& axis : gS) {
-		for (auto& slice : axis) {
-			slice.second.simplifySurfaces();
-		}
-	}
-	
-	log("Building slices triangulations", 3);
+	// Slices are independent, so each one is processed as a single task.
+	std::vector<Slice*> slices;
 	for (auto& axis : gS) {
 		for (auto& slice : axis) {
-			slice.second.buildTriangulations();
+			slices.push_back(&slice);
 		}
 	}
 
-	log("Building slices search maps", 3); 
+	log("Resolving, simplifying, triangulating and indexing slices", 3);
 	std::for_each(
 #ifdef TESSELLATOR_EXECUTION_POLICIES
 		std::execution::par,
 #endif
-		gS.begin(), gS.end(),
-		[&](auto& axis) {
-			std::for_each(
-#ifdef TESSELLATOR_EXECUTION_POLICIES
-				std::execution::par,
-#endif
-				axis.begin(), axis.end(),
-				[&](auto& slice) {
-					slice.second.buildSearchMap();
-					slice.second.cleanSurfaces();
-				}
-			);
+		slices.begin(), slices.end(),
+		[&](auto& slice) {
+			slice->resolvePriorities();
+			slice->simplifySurfaces();
+			slice->buildTriangulations();
+			slice->buildSearchMap();
+			slice->cleanSurfaces();
 		}
 	);
 }
@@ -473,11 +526,11 @@ Mesh initializeMeshIfEmpty(const Mesh& lhs, const Mesh& rhs)
 	}
 }
 
-FillerPolyhedrons buildFillerPolyhedrons(
+FillerPolyhedrons buildManifoldPolyhedrons(
 	const Coordinates& vCoords,
 	const Elements& vElems,
 	const Coordinates& sCoords,
-	const Elements& sElems )
+	const Elements& sElems)
 {
 	FillerPolyhedrons r;
 	
@@ -492,6 +545,11 @@ FillerPolyhedrons buildFillerPolyhedrons(
 	}
 
 	CGAL::copy_face_graph(buildPolyhedronFromElements(sCoords, sElems), r.surfaces);
+	return r;
+}
+
+void extractAlignedPolyhedron(FillerPolyhedrons& r)
+{
 	Polyhedron pAux{r.volumes};
 	reassignFacetsWithPredicate(r.aligned, pAux, isFaceContainedInAnyCartesianPlane);
 	reassignFacetsWithPredicate(r.aligned, r.surfaces, isFaceContainedInAnyCartesianPlane);
@@ -504,10 +562,103 @@ FillerPolyhedrons buildFillerPolyhedrons(
 			<< " invalid facets which will be ignored" << std::endl;
 		throw std::runtime_error("Invalid areas exist");
 	}
+}
+
+FillerPolyhedrons buildFillerPolyhedrons(
+	const Coordinates& vCoords,
+	const Elements& vElems,
+	const Coordinates& sCoords,
+	const Elements& sElems )
+{
+	auto r{ buildManifoldPolyhedrons(vCoords, vElems, sCoords, sElems) };
+	extractAlignedPolyhedron(r);
 	return r; 
 }
 
-Filler::Filler(
+using PointMap = std::map<Point3, Point3>;
+
+void addToPointMap(PointMap& res, const Coordinates& from, const Coordinates& to)
+{
+	assert(from.size() == to.size());
+	for (std::size_t i{ 0 }; i < from.size(); ++i) {
+		res.emplace(
+			Point3(from[i][X], from[i][Y], from[i][Z]),
+			Point3(to[i][X], to[i][Y], to[i][Z]));
+	}
+}
+
+FillerPolyhedrons movePolyhedrons(const FillerPolyhedrons& manifold, const PointMap& pointMap)
+{
+	// Manifold polyhedrons only reuse the mesh coordinates, so all their
+	// vertices are found in the map.
+	FillerPolyhedrons r;
+	r.volumes = manifold.volumes;
+	r.surfaces = manifold.surfaces;
+	for (auto* p : { &r.volumes, &r.surfaces }) {
+		for (auto v{ p->vertices_begin() }; v != p->vertices_end(); ++v) {
+			v->point() = pointMap.at(v->point());
+		}
+	}
+	extractAlignedPolyhedron(r);
+	return r;
+}
+
+void rethrowFirstException(const std::vector<std::exception_ptr>& errors)
+{
+	// Exceptions must not escape parallel algorithms, so they are stored by
+	// each task and the first one is rethrown in task order.
+	for (const auto& e : errors) {
+		if (e) {
+			std::rethrow_exception(e);
+		}
+	}
+}
+
+template <typename SliceGroup, typename MergeGroup>
+void sliceAndMergeGroups(
+	const std::size_t numberOfGroups,
+	const SliceGroup& sliceGroup,
+	const MergeGroup& mergeGroup)
+{
+	// Groups are sliced in parallel in chunks which are merged in order and
+	// released before slicing the next one, so only the slices of a chunk
+	// are kept in memory at a time.
+	using Result = decltype(sliceGroup(std::size_t{}));
+	const std::size_t chunkSize{ std::max<std::size_t>(1, std::thread::hardware_concurrency()) };
+	for (std::size_t begin{ 0 }; begin < numberOfGroups; begin += chunkSize) {
+		const std::size_t end{ std::min(begin + chunkSize, numberOfGroups) };
+		std::vector<Result> results(end - begin);
+		std::vector<std::exception_ptr> errors(end - begin);
+		std::vector<std::size_t> gIds(end - begin);
+		std::iota(gIds.begin(), gIds.end(), begin);
+		std::for_each(
+#ifdef TESSELLATOR_EXECUTION_POLICIES
+			std::execution::par,
+#endif
+			gIds.begin(), gIds.end(),
+			[&](const auto& gId) {
+				try {
+					results[gId - begin] = sliceGroup(gId);
+				}
+				catch (...) {
+					errors[gId - begin] = std::current_exception();
+				}
+			}
+		);
+		rethrowFirstException(errors);
+		for (std::size_t gId{ begin }; gId < end; ++gId) {
+			mergeGroup(gId, results[gId - begin]);
+		}
+	}
+}
+
+bool haveSameElements(const Mesh& lhs, const Mesh& rhs)
+{
+	return lhs.coordinates.size() == rhs.coordinates.size()
+		&& lhs.groups == rhs.groups;
+}
+
+std::pair<Mesh, Mesh> Filler::initialize(
 	const Mesh& volumeMesh,
 	const Mesh& surfaceMesh,
 	const std::vector<Priority>& groupPriorities)
@@ -529,44 +680,174 @@ Filler::Filler(
 		groupPriorities_.resize(vM.groups.size());
 		std::iota(groupPriorities_.begin(), groupPriorities_.end(), 0);
 	}
-	auto vGroups{ vM.groups };
-	auto sGroups{ sM.groups };
-	mergeGroupsWithSamePriority(vGroups, sGroups);
-
-	for (std::size_t gId{ 0 }; gId < vGroups.size(); ++gId) {
-		std::stringstream ss;
-		ss << "Building filler for group " << gId;
-		log(ss.str(), 1);
-		auto fP{
-			buildFillerPolyhedrons(
-				vM.coordinates, vGroups[gId].elements,
-				sM.coordinates, sGroups[gId].elements)
-		};
-		const auto pr{ getGroupPriority(gId) };
-		
-		log("Slicing volumes", 2);
-		sliceNonAlignedByGrid(slices_, fP.volumes, grid_, pr, SlicingMode::Volume);
-		log("Slicing surfaces", 2);
-		sliceNonAlignedByGrid(slices_, fP.surfaces, grid_, pr, SlicingMode::Surface);
-		log("Slicing aligned", 2);
-		sliceAlignedByGrid(slices_, fP.aligned, grid_, pr);
-		log("Building segments arrays", 2);
-		buildSegmentsArray(segmentsArray_, fP.aligned, grid_, pr);
-		buildSegmentsArray(segmentsArray_, fP.volumes, grid_, pr);
+	for (const auto& x : { X, Y, Z }) {
+		slices_[x] = Slices(grid_[x].size());
 	}
+
+	mergeGroupsWithSamePriority(vM.groups, sM.groups);
+	return { std::move(vM), std::move(sM) };
+}
+
+void Filler::merge(const GroupId& gId, GroupSlices& gS)
+{
+	std::stringstream ss;
+	ss << "Merging slices of group " << gId;
+	log(ss.str(), 1);
+	const auto pr{ getGroupPriority(gId) };
+	sliceNonAlignedByGrid(slices_, gS.volumes, pr, SlicingMode::Volume);
+	sliceNonAlignedByGrid(slices_, gS.surfaces, pr, SlicingMode::Surface);
+	sliceAlignedByGrid(slices_, gS.aligned, pr);
+	buildSegmentsArray(segmentsArray_, gS.alignedPieces, pr);
+	buildSegmentsArray(segmentsArray_, gS.volumePieces, pr);
+	gS = GroupSlices();
+}
+
+void Filler::finish()
+{
+	log("Building segments length fractions", 2);
+	buildLengthFractions(segmentsArray_);
 	log("Building slices search maps", 2);
 	buildGridSlicesSearchMaps(slices_);
 	log("Filling finished");
 }
 
+Filler::Filler(
+	const Mesh& volumeMesh,
+	const Mesh& surfaceMesh,
+	const std::vector<Priority>& groupPriorities)
+{
+	Mesh vM, sM;
+	std::tie(vM, sM) = initialize(volumeMesh, surfaceMesh, groupPriorities);
+
+	// Groups are sliced independently and merged in decreasing priority.
+	log("Slicing groups", 1);
+	sliceAndMergeGroups(vM.groups.size(),
+		[&](const std::size_t& gId) {
+			return buildGroupSlices(
+				buildFillerPolyhedrons(
+					vM.coordinates, vM.groups[gId].elements,
+					sM.coordinates, sM.groups[gId].elements),
+				grid_);
+		},
+		[&](const std::size_t& gId, GroupSlices& gS) {
+			merge(gId, gS);
+		}
+	);
+	finish();
+}
+
+std::pair<Filler, Filler> Filler::buildPrimalAndDual(
+	const Mesh& volumeMesh,
+	const Mesh& surfaceMesh,
+	const Mesh& dualVolumeMesh,
+	const Mesh& dualSurfaceMesh,
+	const std::vector<Priority>& groupPriorities)
+{
+	Filler primal, dual;
+	Mesh vM, sM, dVM, dSM;
+	std::tie(vM, sM) = primal.initialize(volumeMesh, surfaceMesh, groupPriorities);
+	std::tie(dVM, dSM) = dual.initialize(dualVolumeMesh, dualSurfaceMesh, groupPriorities);
+	if (!haveSameElements(vM, dVM) || !haveSameElements(sM, dSM)) {
+		return {
+			Filler{ volumeMesh, surfaceMesh, groupPriorities },
+			Filler{ dualVolumeMesh, dualSurfaceMesh, groupPriorities }
+		};
+	}
+
+	PointMap pointMap;
+	addToPointMap(pointMap, vM.coordinates, dVM.coordinates);
+	addToPointMap(pointMap, sM.coordinates, dSM.coordinates);
+
+	// Each group is made manifold once and sliced by both grids in the
+	// same task.
+	log("Slicing groups in primal and dual grids", 1);
+	sliceAndMergeGroups(vM.groups.size(),
+		[&](const std::size_t& gId) {
+			auto manifold{ buildManifoldPolyhedrons(
+				vM.coordinates, vM.groups[gId].elements,
+				sM.coordinates, sM.groups[gId].elements) };
+			auto dualSlices{ buildGroupSlices(movePolyhedrons(manifold, pointMap), dual.grid_) };
+			extractAlignedPolyhedron(manifold);
+			return std::make_pair(buildGroupSlices(manifold, primal.grid_), std::move(dualSlices));
+		},
+		[&](const std::size_t& gId, std::pair<GroupSlices, GroupSlices>& slices) {
+			primal.merge(gId, slices.first);
+			dual.merge(gId, slices.second);
+		}
+	);
+	primal.finish();
+	dual.finish();
+	return { std::move(primal), std::move(dual) };
+}
+
+const Slice* Filler::getSlice(const CellIndex& c) const
+{
+	const auto& slices{ slices_[c.axis] };
+	const SliceNumber i{ c.getSliceNumber() };
+	if (!isInSlices(slices, i)) {
+		return nullptr;
+	}
+	return &slices[i];
+}
+
+std::size_t estimateMemory(const FaceFilling& ff)
+{
+	// Map nodes are estimated as four pointers plus their value.
+	const std::size_t node{ 4 * sizeof(void*) };
+	std::size_t res{ sizeof(FaceFilling) };
+	for (const auto& [pr, pls] : ff.lins) {
+		res += node + sizeof(Polylines2);
+		for (const auto& pl : pls) {
+			res += sizeof(Polyline2) + pl.size() * sizeof(Point2);
+		}
+	}
+	for (const auto& [pr, pS] : ff.tris) {
+		res += node + sizeof(HPolygonSet);
+		for (const auto& pwh : pS.getPolygonsWithHoles()) {
+			res += sizeof(PolygonWH) + pwh.outer_boundary().size() * sizeof(Point2);
+			for (const auto& h : pwh.holes()) {
+				res += sizeof(Polygon) + h.size() * sizeof(Point2);
+			}
+		}
+	}
+	return res;
+}
+
+void Filler::setFaceFillingCacheBudget(std::size_t bytes)
+{
+	if (bytes == 0) {
+		faceFillingCache_.reset();
+		return;
+	}
+	faceFillingCache_ = std::make_unique<FaceFillingCache>(bytes, estimateMemory);
+}
+
+Filler::FaceFillingCache::Stats Filler::getFaceFillingCacheStats() const
+{
+	if (!faceFillingCache_) {
+		return FaceFillingCache::Stats{};
+	}
+	return faceFillingCache_->getStats();
+}
+
 FaceFilling Filler::getFaceFilling(const CellIndex& c) const
 {
 	//assert(getFillingState(c).partial());
-	auto it{ slices_[c.axis].find(c.getSliceNumber()) };
-	if (it != slices_[c.axis].end()) {
-		return it->second.getFaceFilling(c.getArrayIndex());
+	if (faceFillingCache_) {
+		if (auto cached{ faceFillingCache_->find(c) }) {
+			return *cached;
+		}
+	}
+
+	FaceFilling res;
+	const Slice* slice{ getSlice(c) };
+	if (slice != nullptr) {
+		res = slice->getFaceFilling(c.getArrayIndex());
+	}
+	if (faceFillingCache_) {
+		faceFillingCache_->insert(c, res);
 	}
-	return FaceFilling();
+	return res;
 }
 
 EdgeFilling Filler::getEdgeFilling(const CellIndex& c) const 
@@ -583,79 +864,219 @@ EdgeFilling Filler::getEdgeFilling(const CellIndex& c) const
 
 FillingState Filler::getFillingState(const CellIndex& c) const
 {
-	auto it{ slices_[c.axis].find(c.getSliceNumber())};
-	if (it == slices_[c.axis].end()) {
+	const Slice* slice{ getSlice(c) };
+	if (slice == nullptr) {
 		return { FillingType::Empty };
 	}
 	else {
-		return it->second.getFillingState(c.getArrayIndex());
+		return slice->getFillingState(c.getArrayIndex());
 	}
 }
 
-Elements buildTriangleElements(Coordinates& cs, const TriVs tris) 
+void Filler::getFillingStates(FillingStates& res, const Axis& x, const SliceNumber& i) const
 {
-	Elements r;
-	for (const auto& p : tris) {
-		Element e;
-		e.type = Element::Type::Surface;
-		e.vertices.reserve(3);
-		for (const auto& v : p) {
-			e.vertices.push_back(cs.size());
-			cs.push_back(v);
+	const ArrayIndex size{ getSliceSize(x) };
+	if (!isInSlices(slices_[x], i)) {
+		res.assign(std::size_t(size[0]) * size[1], FillingState{ FillingType::Empty });
+		return;
+	}
+	slices_[x][i].getFillingStates(res, size);
+}
+
+std::vector<Filler::FillingStates> Filler::getFillingStates(const Axis& x) const
+{
+	std::vector<FillingStates> res(slices_[x].size());
+	std::vector<SliceNumber> sliceNumbers(slices_[x].size());
+	std::iota(sliceNumbers.begin(), sliceNumbers.end(), 0);
+	std::for_each(
+#ifdef TESSELLATOR_EXECUTION_POLICIES
+		std::execution::par,
+#endif
+		sliceNumbers.begin(), sliceNumbers.end(),
+		[&](const auto& i) {
+			getFillingStates(res[i], x, i);
 		}
-		r.push_back(e);
+	);
+	return res;
+}
+
+ArrayIndex Filler::getSliceSize(const Axis& x) const
+{
+	return {
+		std::max((CellDir)grid_[(x + 1) % 3].size() - 1, 0),
+		std::max((CellDir)grid_[(x + 2) % 3].size() - 1, 0)
+	};
+}
+
+Fractions Filler::getAreaFractions(const CellIndex& c) const
+{
+	const Slice* slice{ getSlice(c) };
+	if (slice == nullptr) {
+		return Fractions();
 	}
-	return r;
+	return slice->getAreaFractions(c.getArrayIndex());
+}
+
+Fractions Filler::getLengthFractions(const CellIndex& c) const
+{
+	auto it{ segmentsArray_[c.axis].find(c.getArrayIndex()) };
+	if (it == segmentsArray_[c.axis].end()) {
+		return Fractions();
+	}
+	return it->second.getLengthFractions(c.getSliceNumber());
+}
+
+void Filler::getAreaFractions(
+	std::vector<double>& res,
+	const Axis& x,
+	const SliceNumber& i,
+	const Priority& pr) const
+{
+	const ArrayIndex size{ getSliceSize(x) };
+	if (!isInSlices(slices_[x], i)) {
+		res.assign(std::size_t(size[0]) * size[1], 0.0);
+		return;
+	}
+	slices_[x][i].getAreaFractions(res, size, pr);
 }
 
-Elements buildLineElements(Coordinates& cs, const LinVs lins)
+void Filler::getLengthFractions(
+	std::vector<double>& res,
+	const Axis& x,
+	const ArrayIndex& ij,
+	const Priority& pr) const
 {
-	Elements r;
-	for (const auto& p : lins) {
-		Element e;
-		e.type = Element::Type::Line;
-		e.vertices.reserve(2);
-		for (const auto& v : p) {
-			e.vertices.push_back(cs.size());		
-			cs.push_back(v);
+	res.assign(std::max((CellDir)grid_[x].size() - 1, 0), 0.0);
+	auto it{ segmentsArray_[x].find(ij) };
+	if (it == segmentsArray_[x].end()) {
+		return;
+	}
+	for (std::size_t c{ 0 }; c < res.size(); ++c) {
+		const auto fractions{ it->second.getLengthFractions((CellDir)c) };
+		auto frac{ fractions.find(pr) };
+		if (frac != fractions.end()) {
+			res[c] = frac->second;
 		}
-		r.push_back(e);
 	}
-	return r;
 }
 
-void insertElementsInGroup(Group& g, const Elements& es)
+void Filler::visitPartialFaces(const FaceFillingVisitor& visitor) const
 {
-	g.elements.insert(
-		g.elements.end(),
-		es.begin(), es.end()
+	struct FacesRow {
+		Axis x;
+		SliceNumber i;
+		std::vector<ArrayIndex> faces;
+	};
+	std::vector<FacesRow> rows;
+	for (const auto& x : { X, Y, Z }) {
+		for (std::size_t i{ 0 }; i < slices_[x].size(); ++i) {
+			for (auto& faces : slices_[x][i].getPartialFacesRows()) {
+				rows.push_back({ x, (SliceNumber)i, std::move(faces) });
+			}
+		}
+	}
+
+	std::for_each(
+#ifdef TESSELLATOR_EXECUTION_POLICIES
+		std::execution::par,
+#endif
+		rows.begin(), rows.end(),
+		[&](const auto& row) {
+			const auto fillings{ slices_[row.x][row.i].getFaceFillings(row.faces) };
+			Cell c;
+			c[row.x] = row.i;
+			for (std::size_t n{ 0 }; n < row.faces.size(); ++n) {
+				c[(row.x + 1) % 3] = row.faces[n][0];
+				c[(row.x + 2) % 3] = row.faces[n][1];
+				visitor({ c, row.x }, fillings[n]);
+			}
+		}
 	);
 }
 
+void Filler::save(const std::string& path) const
+{
+	fillerFile::Writer w;
+	for (const auto& x : { X, Y, Z }) {
+		for (const auto& slice : slices_[x]) {
+			slice.write(w, x);
+		}
+	}
+	for (const auto& x : { X, Y, Z }) {
+		std::vector<ArrayIndex> ijs;
+		ijs.reserve(segmentsArray_[x].size());
+		for (const auto& [ij, segs] : segmentsArray_[x]) {
+			ijs.push_back(ij);
+		}
+		std::sort(ijs.begin(), ijs.end());
+		for (const auto& ij : ijs) {
+			std::vector<fillerFile::LineSegmentRecord> records;
+			for (const auto& [pr, segs] : segmentsArray_[x].at(ij).getSegments()) {
+				for (const auto& s : segs) {
+					records.push_back({ { s[0], s[1] }, pr });
+				}
+			}
+			w.addLine(x, ij, records);
+		}
+	}
+	w.write(path);
+}
+
 Mesh Filler::getMeshFilling() const
 {
+	std::vector<std::pair<Axis, std::size_t>> sliceIds;
+	for (const auto& x : { X, Y, Z }) {
+		for (std::size_t i{ 0 }; i < slices_[x].size(); ++i) {
+			sliceIds.push_back({ x, i });
+		}
+	}
+
+	std::map<Priority, std::vector<GroupId>> groupsOfPriority;
 	Mesh m;
 	m.grid = grid_;
 	m.groups.resize(groupPriorities_.size());
-	for (auto gId{0}; gId < m.groups.size(); ++gId) {
-		for (const auto& x : { X, Y, Z }) {
-			for (const auto& [i, slice]: slices_[x]) {
-				const Priority pr{ getGroupPriority(gId) };
-				insertElementsInGroup(
-					m.groups[gId],
-					buildTriangleElements(
-						m.coordinates,
-						slice.buildAllTriVs(pr, x, (Height)i)
-					)
-				);
-				insertElementsInGroup(
-					m.groups[gId],
-					buildLineElements(
-						m.coordinates,
-						slice.buildAllLinVs(pr, x, (Height)i)
-					)
-				);
+	for (GroupId gId{ 0 }; gId < m.groups.size(); ++gId) {
+		groupsOfPriority[getGroupPriority(gId)].push_back(gId);
+	}
 
+	// Slices are built in parallel in chunks which are appended in order
+	// before building the next one, each slice shifting the coordinate ids
+	// of its elements by the coordinates of the previous ones.
+	const std::size_t chunkSize{ std::max<std::size_t>(1, std::thread::hardware_concurrency()) };
+	for (std::size_t begin{ 0 }; begin < sliceIds.size(); begin += chunkSize) {
+		const std::size_t end{ std::min(begin + chunkSize, sliceIds.size()) };
+		std::vector<Slice::IndexedFilling> fillings(end - begin);
+		std::vector<std::size_t> ns(end - begin);
+		std::iota(ns.begin(), ns.end(), 0);
+		std::for_each(
+#ifdef TESSELLATOR_EXECUTION_POLICIES
+			std::execution::par,
+#endif
+			ns.begin(), ns.end(),
+			[&](const auto& n) {
+				const auto& [x, i] { sliceIds[begin + n] };
+				fillings[n] = slices_[x][i].buildIndexedFilling(x, (Height)i);
+			}
+		);
+
+		for (auto& filling : fillings) {
+			const CoordinateId offset{ m.coordinates.size() };
+			m.coordinates.insert(m.coordinates.end(),
+				filling.coordinates.begin(), filling.coordinates.end());
+			for (auto& [pr, es] : filling.elements) {
+				auto it{ groupsOfPriority.find(pr) };
+				if (it == groupsOfPriority.end()) {
+					continue;
+				}
+				for (auto& e : es) {
+					for (auto& v : e.vertices) {
+						v += offset;
+					}
+				}
+				for (const auto& gId : it->second) {
+					auto& g{ m.groups[gId] };
+					g.elements.insert(g.elements.end(), es.begin(), es.end());
+				}
 			}
 		}
 	}
@@ -3,20 +3,26 @@
 #include "types/Mesh.h"
 
 #include "utils/GridTools.h"
+#include "utils/LRUCache.h"
 #include "utils/Types.h"
 
 #include "Slice.h"
 #include "SegmentsArray.h"
 
+#include <memory>
+
 namespace meshlib {
 namespace tessellator {
 namespace filler {
 
+struct GroupSlices;
+
 class Filler {
 public:
-	using Slices = std::map<SliceNumber, Slice>;
+	// Slices are indexed by slice number, one per grid plane.
+	using Slices = std::vector<Slice>;
 	using GridSlices = std::array<Slices, 3>;
-	using SegmentsArray = std::map<ArrayIndex, Segments>;
+	using SegmentsArray = boost::unordered_map<ArrayIndex, Segments>;
 	using GridSegmentsArray = std::array<SegmentsArray, 3>;
 
 	Filler(
@@ -29,21 +35,70 @@ public:
 	Filler& operator=(Filler&&) = default;
 	~Filler() = default;
 
+	// Builds the fillers of the same meshes given in the primal and dual
+	// grids. Polyhedrons of each group are built once and moved to the dual
+	// grid, which requires both pairs of meshes to have the same elements.
+	// Otherwise, fillers are built independently.
+	static std::pair<Filler, Filler> buildPrimalAndDual(
+		const Mesh& volumeMesh,
+		const Mesh& surfaceMesh,
+		const Mesh& dualVolumeMesh,
+		const Mesh& dualSurfaceMesh,
+		const std::vector<Priority>& groupPriorities = std::vector<Priority>());
+
 	EdgeFilling getEdgeFilling(const CellIndex&) const;
 	FaceFilling getFaceFilling(const CellIndex&) const;
 
+	// Face fillings are cached up to the given estimated memory, in bytes.
+	// Caching is disabled by default and with a budget of zero.
+	using FaceFillingCache = utils::LRUCache<CellIndex, FaceFilling, CellIndexHash>;
+	void setFaceFillingCacheBudget(std::size_t bytes);
+	FaceFillingCache::Stats getFaceFillingCacheStats() const;
+
 	FillingState getFillingState(const CellIndex&) const;
+
+	// States of all faces of a slice, stored row major by array index.
+	using FillingStates = std::vector<FillingState>;
+	void getFillingStates(FillingStates&, const Axis&, const SliceNumber&) const;
+	std::vector<FillingStates> getFillingStates(const Axis&) const;
+
+	// Filled fraction of the area of a face and of the length of an edge
+	// per priority, precomputed when building the filler.
+	Fractions getAreaFractions(const CellIndex&) const;
+	Fractions getLengthFractions(const CellIndex&) const;
+	// Fractions of a priority for all faces of a slice, row major by array
+	// index, and for all edges of a grid line.
+	void getAreaFractions(std::vector<double>&, const Axis&, const SliceNumber&, const Priority&) const;
+	void getLengthFractions(std::vector<double>&, const Axis&, const ArrayIndex&, const Priority&) const;
+
+	// Visits every partially filled face once. Rows of faces are visited in
+	// parallel, so the visitor may be called concurrently.
+	using FaceFillingVisitor = std::function<void(const CellIndex&, const FaceFilling&)>;
+	void visitPartialFaces(const FaceFillingVisitor&) const;
 	
 	Mesh getMeshFilling() const;
 
+	// Writes filling states, partial faces and edge segments to a binary
+	// file which is queried in place by MappedFiller.
+	void save(const std::string& path) const;
+
 private:
+	Filler() = default;
+
 	GridSlices slices_;
 	GridSegmentsArray segmentsArray_;
 	Grid grid_;
 	std::vector<Priority> groupPriorities_;
+	std::unique_ptr<FaceFillingCache> faceFillingCache_;
 	Priority getGroupPriority(const GroupId& gId) const;
+	const Slice* getSlice(const CellIndex&) const;
+	ArrayIndex getSliceSize(const Axis&) const;
 
 	void mergeGroupsWithSamePriority(Groups& vGroups, Groups& sGroups);
+	std::pair<Mesh, Mesh> initialize(const Mesh& volumeMesh, const Mesh& surfaceMesh, const std::vector<Priority>&);
+	// Groups must be merged in increasing id, the given slices are released.
+	void merge(const GroupId&, GroupSlices&);
+	void finish();
 
 };
 
@@ -0,0 +1,306 @@
+#include "FillerFile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace meshlib {
+namespace tessellator {
+namespace filler {
+namespace fillerFile {
+
+const std::array<char, 8> magic{ 'T', 'E', 'S', 'F', 'I', 'L', 'L', 0 };
+const std::uint32_t version{ 1 };
+const std::uint64_t alignment{ 8 };
+
+std::uint64_t align(const std::uint64_t& offset)
+{
+	return (offset + alignment - 1) / alignment * alignment;
+}
+
+template<typename T, typename It>
+Range append(std::vector<T>& v, It begin, It end)
+{
+	Range res{ v.size(), 0 };
+	v.insert(v.end(), begin, end);
+	res.end = v.size();
+	return res;
+}
+
+void extend(Range& r, const std::uint64_t& index)
+{
+	if (r.begin == r.end) {
+		r.begin = index;
+	}
+	r.end = index + 1;
+}
+
+void Writer::addSlice(const Axis& x, const FillingRaster& raster, const std::vector<Face>& faces)
+{
+	extend(header_.slices[x], slices_.size());
+
+	const auto view{ raster.getView() };
+	const std::size_t numberOfRowBegins{ view.numberOfRows == 0 ? 0 : view.numberOfRows + 1 };
+	SliceRecord s{};
+	s.firstRow = view.firstRow;
+	s.rowBegins = append(rowBegins_, view.rowBegins, view.rowBegins + numberOfRowBegins);
+	s.runs = append(runs_, view.runs, view.runs + raster.numberOfRuns());
+	s.priorities = append(priorities_, view.priorities, view.priorities + raster.numberOfPriorities());
+
+	s.faces.begin = faces_.size();
+	for (const auto& f : faces) {
+		FaceRecord r{};
+		r.idx = f.idx;
+		r.triangles = append(triangles_, f.triangles.begin(), f.triangles.end());
+		r.segments = append(segments_, f.segments.begin(), f.segments.end());
+		r.fractions = append(fractions_, f.fractions.begin(), f.fractions.end());
+		faces_.push_back(r);
+	}
+	s.faces.end = faces_.size();
+	slices_.push_back(s);
+}
+
+void Writer::addLine(const Axis& x, const ArrayIndex& idx, const std::vector<LineSegmentRecord>& segs)
+{
+	extend(header_.lines[x], lines_.size());
+	LineRecord r{};
+	r.idx = idx;
+	r.segments = append(lineSegments_, segs.begin(), segs.end());
+	lines_.push_back(r);
+}
+
+template<typename T>
+void writeSection(std::ofstream& out, const std::vector<T>& v)
+{
+	const std::uint64_t size{ v.size() * sizeof(T) };
+	out.write(reinterpret_cast<const char*>(v.data()), size);
+	const std::vector<char> padding(align(size) - size, 0);
+	out.write(padding.data(), padding.size());
+}
+
+void Writer::write(const std::string& path) const
+{
+	Header header{ header_ };
+	header.magic = magic;
+	header.version = version;
+
+	std::uint64_t offset{ align(sizeof(Header)) };
+	auto place = [&](const Section& s, const std::size_t& count, const std::size_t& size) {
+		header.sections[(std::size_t)s] = { offset, count };
+		offset = align(offset + count * size);
+	};
+	place(Section::Slices, slices_.size(), sizeof(SliceRecord));
+	place(Section::RowBegins, rowBegins_.size(), sizeof(std::uint64_t));
+	place(Section::Runs, runs_.size(), sizeof(FillingRaster::Run));
+	place(Section::Priorities, priorities_.size(), sizeof(Priority));
+	place(Section::Faces, faces_.size(), sizeof(FaceRecord));
+	place(Section::Triangles, triangles_.size(), sizeof(TriangleRecord));
+	place(Section::Segments, segments_.size(), sizeof(SegmentRecord));
+	place(Section::Fractions, fractions_.size(), sizeof(FractionRecord));
+	place(Section::Lines, lines_.size(), sizeof(LineRecord));
+	place(Section::LineSegments, lineSegments_.size(), sizeof(LineSegmentRecord));
+
+	std::ofstream out(path, std::ios::binary);
+	if (!out) {
+		throw std::runtime_error("Unable to open filler file " + path);
+	}
+	writeSection(out, std::vector<Header>{ header });
+	writeSection(out, slices_);
+	writeSection(out, rowBegins_);
+	writeSection(out, runs_);
+	writeSection(out, priorities_);
+	writeSection(out, faces_);
+	writeSection(out, triangles_);
+	writeSection(out, segments_);
+	writeSection(out, fractions_);
+	writeSection(out, lines_);
+	writeSection(out, lineSegments_);
+	if (!out) {
+		throw std::runtime_error("Unable to write filler file " + path);
+	}
+}
+
+MappedFile::MappedFile(const std::string& path) :
+	file_{ path.c_str(), boost::interprocess::read_only },
+	region_{ file_, boost::interprocess::read_only }
+{
+	if (region_.get_size() < sizeof(Header)) {
+		throw std::runtime_error("Invalid filler file " + path);
+	}
+	header_ = static_cast<const Header*>(region_.get_address());
+	if (header_->magic != magic || header_->version != version) {
+		throw std::runtime_error("Invalid filler file " + path);
+	}
+
+	const std::array<std::size_t, numberOfSections> sizes{
+		sizeof(SliceRecord), sizeof(std::uint64_t), sizeof(FillingRaster::Run),
+		sizeof(Priority), sizeof(FaceRecord), sizeof(TriangleRecord),
+		sizeof(SegmentRecord), sizeof(FractionRecord), sizeof(LineRecord),
+		sizeof(LineSegmentRecord)
+	};
+	const std::uint64_t fileSize{ region_.get_size() };
+	for (std::size_t s{ 0 }; s < numberOfSections; ++s) {
+		const auto& section{ header_->sections[s] };
+		if (section.offset % alignment != 0 ||
+			section.offset > fileSize ||
+			section.count > (fileSize - section.offset) / sizes[s]) {
+			throw std::runtime_error("Truncated filler file " + path);
+		}
+	}
+	if (!isValid()) {
+		throw std::runtime_error("Invalid filler file " + path);
+	}
+}
+
+template<typename T>
+Records<T> MappedFile::getRecords(const Section& s, const Range& r) const
+{
+	const char* base{ static_cast<const char*>(region_.get_address()) };
+	const T* first{ reinterpret_cast<const T*>(base + header_->sections[(std::size_t)s].offset) };
+	return Records<T>{ first + r.begin, first + r.end };
+}
+
+template<typename T>
+Records<T> MappedFile::getRecords(const Section& s) const
+{
+	return getRecords<T>(s, Range{ 0, header_->sections[(std::size_t)s].count });
+}
+
+bool isInside(const Range& r, const std::uint64_t& size)
+{
+	return r.begin <= r.end && r.end <= size;
+}
+
+bool MappedFile::isValid() const
+{
+	// Every range is checked once, so queries index records unchecked.
+	const auto slices{ getRecords<SliceRecord>(Section::Slices) };
+	const auto lines{ getRecords<LineRecord>(Section::Lines) };
+	for (const auto& x : { X, Y, Z }) {
+		if (!isInside(header_->slices[x], slices.size()) ||
+			!isInside(header_->lines[x], lines.size())) {
+			return false;
+		}
+	}
+
+	const auto size = [&](const Section& s) { return header_->sections[(std::size_t)s].count; };
+	for (const auto& s : slices) {
+		if (!isInside(s.rowBegins, size(Section::RowBegins)) ||
+			!isInside(s.runs, size(Section::Runs)) ||
+			!isInside(s.priorities, size(Section::Priorities)) ||
+			!isInside(s.faces, size(Section::Faces))) {
+			return false;
+		}
+		const auto rowBegins{ getRecords<std::uint64_t>(Section::RowBegins, s.rowBegins) };
+		const std::uint64_t numberOfRuns{ s.runs.end - s.runs.begin };
+		for (std::size_t r{ 0 }; r < rowBegins.size(); ++r) {
+			if (rowBegins[r] > numberOfRuns || (r > 0 && rowBegins[r] < rowBegins[r - 1])) {
+				return false;
+			}
+		}
+		const std::uint64_t numberOfPriorities{ s.priorities.end - s.priorities.begin };
+		for (const auto& run : getRecords<FillingRaster::Run>(Section::Runs, s.runs)) {
+			const FillingType type{ (FillingType)(run.code & 3) };
+			if (type != FillingType::Empty && type != FillingType::Partial && type != FillingType::Full) {
+				return false;
+			}
+			if (type == FillingType::Full && (std::uint64_t)(run.code >> 2) >= numberOfPriorities) {
+				return false;
+			}
+		}
+	}
+
+	for (const auto& f : getRecords<FaceRecord>(Section::Faces)) {
+		if (!isInside(f.triangles, size(Section::Triangles)) ||
+			!isInside(f.segments, size(Section::Segments)) ||
+			!isInside(f.fractions, size(Section::Fractions))) {
+			return false;
+		}
+	}
+	for (const auto& l : lines) {
+		if (!isInside(l.segments, size(Section::LineSegments))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+std::size_t MappedFile::numberOfSlices(const Axis& x) const
+{
+	return header_->slices[x].end - header_->slices[x].begin;
+}
+
+const SliceRecord* MappedFile::getSlice(const Axis& x, const SliceNumber& n) const
+{
+	if (n < 0 || n >= (SliceNumber)numberOfSlices(x)) {
+		return nullptr;
+	}
+	return &getRecords<SliceRecord>(Section::Slices)[header_->slices[x].begin + n];
+}
+
+FillingRaster::View MappedFile::getRaster(const Axis& x, const SliceNumber& n) const
+{
+	FillingRaster::View res;
+	const SliceRecord* s{ getSlice(x, n) };
+	if (s == nullptr) {
+		return res;
+	}
+	const auto rowBegins{ getRecords<std::uint64_t>(Section::RowBegins, s->rowBegins) };
+	res.firstRow = s->firstRow;
+	res.numberOfRows = rowBegins.empty() ? 0 : rowBegins.size() - 1;
+	res.rowBegins = rowBegins.begin();
+	res.runs = getRecords<FillingRaster::Run>(Section::Runs, s->runs).begin();
+	res.priorities = getRecords<Priority>(Section::Priorities, s->priorities).begin();
+	return res;
+}
+
+template<typename T>
+const T* findRecord(const Records<T>& records, const ArrayIndex& idx)
+{
+	auto it{ std::lower_bound(records.begin(), records.end(), idx,
+		[](const T& r, const ArrayIndex& i) { return r.idx < i; }
+	) };
+	if (it == records.end() || it->idx != idx) {
+		return nullptr;
+	}
+	return it;
+}
+
+const FaceRecord* MappedFile::findFace(const Axis& x, const SliceNumber& n, const ArrayIndex& idx) const
+{
+	const SliceRecord* s{ getSlice(x, n) };
+	if (s == nullptr) {
+		return nullptr;
+	}
+	return findRecord(getRecords<FaceRecord>(Section::Faces, s->faces), idx);
+}
+
+const LineRecord* MappedFile::findLine(const Axis& x, const ArrayIndex& idx) const
+{
+	return findRecord(getRecords<LineRecord>(Section::Lines, header_->lines[x]), idx);
+}
+
+Records<TriangleRecord> MappedFile::getTriangles(const FaceRecord& f) const
+{
+	return getRecords<TriangleRecord>(Section::Triangles, f.triangles);
+}
+
+Records<SegmentRecord> MappedFile::getSegments(const FaceRecord& f) const
+{
+	return getRecords<SegmentRecord>(Section::Segments, f.segments);
+}
+
+Records<FractionRecord> MappedFile::getFractions(const FaceRecord& f) const
+{
+	return getRecords<FractionRecord>(Section::Fractions, f.fractions);
+}
+
+Records<LineSegmentRecord> MappedFile::getSegments(const LineRecord& l) const
+{
+	return getRecords<LineSegmentRecord>(Section::LineSegments, l.segments);
+}
+
+}
+}
+}
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "FillingRaster.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <array>
+#include <string>
+
+namespace meshlib {
+namespace tessellator {
+namespace filler {
+
+// Binary image of a built filler. Every section is an array of fixed size
+// records, so a mapped file is queried in place without deserializing it.
+// Files are written in native byte order and are not meant to be moved
+// across platforms with a different one.
+namespace fillerFile {
+
+struct Range {
+	std::uint64_t begin;
+	std::uint64_t end;
+};
+
+// Offset in bytes and number of records of a section.
+struct SectionRecord {
+	std::uint64_t offset;
+	std::uint64_t count;
+};
+
+enum class Section {
+	Slices,
+	RowBegins,
+	Runs,
+	Priorities,
+	Faces,
+	Triangles,
+	Segments,
+	Fractions,
+	Lines,
+	LineSegments
+};
+constexpr std::size_t numberOfSections{ 10 };
+
+struct Header {
+	std::array<char, 8> magic;
+	std::uint32_t version;
+	std::uint32_t unused;
+	// Records of each axis in the slices and lines sections.
+	std::array<Range, 3> slices;
+	std::array<Range, 3> lines;
+	std::array<SectionRecord, numberOfSections> sections;
+};
+
+// Ranges index records of the other sections. Row begins are relative to
+// the first run of the slice.
+struct SliceRecord {
+	CellDir firstRow;
+	std::uint32_t unused;
+	Range rowBegins;
+	Range runs;
+	Range priorities;
+	Range faces;
+};
+
+// Faces of a slice holding triangles or segments are stored in raster
+// order, which includes faces that are not partial.
+struct FaceRecord {
+	ArrayIndex idx;
+	Range triangles;
+	Range segments;
+	Range fractions;
+};
+
+struct TriangleRecord {
+	std::array<double, 6> coordinates;
+	Priority priority;
+	std::uint32_t unused;
+};
+
+struct SegmentRecord {
+	std::array<double, 4> coordinates;
+	Priority priority;
+	std::uint32_t unused;
+};
+
+struct FractionRecord {
+	Priority priority;
+	std::uint32_t unused;
+	double value;
+};
+
+// Grid lines of an axis are stored sorted by array index.
+struct LineRecord {
+	ArrayIndex idx;
+	Range segments;
+};
+
+struct LineSegmentRecord {
+	std::array<double, 2> ends;
+	Priority priority;
+	std::uint32_t unused;
+};
+
+template<typename T>
+class Records {
+public:
+	Records(const T* begin, const T* end) : begin_{ begin }, end_{ end } {}
+	const T* begin() const { return begin_; }
+	const T* end() const { return end_; }
+	std::size_t size() const { return end_ - begin_; }
+	bool empty() const { return begin_ == end_; }
+	const T& operator[](std::size_t i) const { return begin_[i]; }
+private:
+	const T* begin_;
+	const T* end_;
+};
+
+class Writer {
+public:
+	struct Face {
+		ArrayIndex idx;
+		std::vector<TriangleRecord> triangles;
+		std::vector<SegmentRecord> segments;
+		std::vector<FractionRecord> fractions;
+	};
+
+	// Slices and lines must be added grouped by axis, in increasing order.
+	// Faces must be given in raster order.
+	void addSlice(const Axis&, const FillingRaster&, const std::vector<Face>&);
+	void addLine(const Axis&, const ArrayIndex&, const std::vector<LineSegmentRecord>&);
+
+	void write(const std::string& path) const;
+
+private:
+	Header header_{};
+	std::vector<SliceRecord> slices_;
+	std::vector<std::uint64_t> rowBegins_;
+	std::vector<FillingRaster::Run> runs_;
+	std::vector<Priority> priorities_;
+	std::vector<FaceRecord> faces_;
+	std::vector<TriangleRecord> triangles_;
+	std::vector<SegmentRecord> segments_;
+	std::vector<FractionRecord> fractions_;
+	std::vector<LineRecord> lines_;
+	std::vector<LineSegmentRecord> lineSegments_;
+};
+
+class MappedFile {
+public:
+	// Throws if the file is not a filler file or any of its ranges indexes
+	// records out of their sections.
+	MappedFile(const std::string& path);
+
+	std::size_t numberOfSlices(const Axis&) const;
+	FillingRaster::View getRaster(const Axis&, const SliceNumber&) const;
+	// Returns nullptr if the face holds no triangles nor segments.
+	const FaceRecord* findFace(const Axis&, const SliceNumber&, const ArrayIndex&) const;
+	const LineRecord* findLine(const Axis&, const ArrayIndex&) const;
+
+	Records<TriangleRecord> getTriangles(const FaceRecord&) const;
+	Records<SegmentRecord> getSegments(const FaceRecord&) const;
+	Records<FractionRecord> getFractions(const FaceRecord&) const;
+	Records<LineSegmentRecord> getSegments(const LineRecord&) const;
+
+private:
+	boost::interprocess::file_mapping file_;
+	boost::interprocess::mapped_region region_;
+	const Header* header_;
+
+	template<typename T>
+	Records<T> getRecords(const Section&, const Range&) const;
+	template<typename T>
+	Records<T> getRecords(const Section&) const;
+	const SliceRecord* getSlice(const Axis&, const SliceNumber&) const;
+	bool isValid() const;
+};
+
+}
+}
+}
+}
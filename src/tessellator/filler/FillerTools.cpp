@@ -3,12 +3,20 @@
 #include "utils/CoordGraph.h"
 #include <boost/bimap.hpp>
 
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <unordered_map>
+
 namespace meshlib {
 namespace tessellator {
 namespace filler {
 
 using namespace cgal;
 
+using Bbox2 = CGAL::Bbox_2;
+
 
 Rectangle2 buildCellFace(const ArrayIndex& c)
 {
@@ -35,6 +43,46 @@ bool isCellCrossedByTriangle(const Triangle2& t, const ArrayIndex& idx)
 	return false;
 }
 
+double computeCellFaceOverlapArea(const Triangle2& t, const ArrayIndex& idx)
+{
+	// Clips the triangle by the four sides of the face in double precision.
+	using Point = std::array<double, 2>;
+	std::vector<Point> poly;
+	for (int i{ 0 }; i < 3; ++i) {
+		poly.push_back({ CGAL::to_double(t.vertex(i).x()), CGAL::to_double(t.vertex(i).y()) });
+	}
+	for (std::size_t d{ 0 }; d < 2; ++d) {
+		for (const auto& [bound, sign] : { std::make_pair(double(idx[d]), 1.0), std::make_pair(double(idx[d] + 1), -1.0) }) {
+			std::vector<Point> clipped;
+			for (std::size_t i{ 0 }; i < poly.size(); ++i) {
+				const Point& p{ poly[i] };
+				const Point& q{ poly[(i + 1) % poly.size()] };
+				const double dp{ sign * (p[d] - bound) };
+				const double dq{ sign * (q[d] - bound) };
+				if (dp >= 0.0) {
+					clipped.push_back(p);
+				}
+				if ((dp < 0.0) != (dq < 0.0)) {
+					const double s{ dp / (dp - dq) };
+					clipped.push_back({ p[0] + s * (q[0] - p[0]), p[1] + s * (q[1] - p[1]) });
+				}
+			}
+			poly = std::move(clipped);
+			if (poly.empty()) {
+				return 0.0;
+			}
+		}
+	}
+
+	double area{ 0.0 };
+	for (std::size_t i{ 0 }; i < poly.size(); ++i) {
+		const Point& p{ poly[i] };
+		const Point& q{ poly[(i + 1) % poly.size()] };
+		area += p[0] * q[1] - q[0] * p[1];
+	}
+	return std::abs(area) / 2.0;
+}
+
 Polygon buildCellFacePolygon(const ArrayIndex& idx)
 {
 	const double x(idx[0]);
@@ -47,6 +95,176 @@ Polygon buildCellFacePolygon(const ArrayIndex& idx)
 	return res;
 }
 
+std::array<ArrayIndex, 2> buildMinAndMaxArrayIndices(const Bbox2& bbox)
+{
+	ArrayIndex minAI{
+		std::numeric_limits<CellDir>::max(),
+		std::numeric_limits<CellDir>::max()
+	};
+	ArrayIndex maxAI{
+		std::numeric_limits<CellDir>::min(),
+		std::numeric_limits<CellDir>::min()
+	};
+	for (auto d{ 0 }; d < 2; ++d) {
+		if ((CellDir)std::floor(bbox.min(d)) < minAI[d]) {
+			minAI[d] = (CellDir)std::floor(bbox.min(d));
+		}
+		if ((CellDir)std::floor(bbox.max(d)) > maxAI[d]) {
+			maxAI[d] = (CellDir)std::ceil(bbox.max(d));
+		}
+	}
+	return { minAI, maxAI };
+}
+
+Bbox2 getBoundingBox(const Polylines2& pls) 
+{
+	assert(!pls.empty());
+
+	std::array<KType, 2> min{
+		std::numeric_limits<KType>::max(),
+		std::numeric_limits<KType>::max()
+	};
+	std::array<KType, 2> max{
+		std::numeric_limits<KType>::min(),
+		std::numeric_limits<KType>::min()
+	};
+	for (const auto& pl : pls) {
+		assert(!pl.empty());
+		for (const auto& p : pl) {
+			for (int d{ 0 }; d < 2; d++) {
+				if (p.cartesian(d) < min[d]) {
+					min[d] = p.cartesian(d);
+				}
+				if (p.cartesian(d) > max[d]) {
+					max[d] = p.cartesian(d);
+				}
+			}
+		}
+	}
+	return Bbox2{ 
+		CGAL::to_double(min[X]), 
+		CGAL::to_double(min[Y]), 
+		CGAL::to_double(max[X]), 
+		CGAL::to_double(max[Y]) 
+	};
+}
+
+// Rows of column i which may touch the segment pq, widened by one row on
+// each side so that rounding never drops a crossed cell. Returns an empty
+// range if the segment does not reach the column.
+std::pair<CellDir, CellDir> buildColumnRowsRange(const Point2& p, const Point2& q, const CellDir& i)
+{
+	double x0{ CGAL::to_double(p.x()) }, y0{ CGAL::to_double(p.y()) };
+	double x1{ CGAL::to_double(q.x()) }, y1{ CGAL::to_double(q.y()) };
+	if (std::max(x0, x1) < i || std::min(x0, x1) > i + 1) {
+		return { 0, 0 };
+	}
+	double ya{ y0 }, yb{ y1 };
+	if (x0 != x1) {
+		auto interpolate = [&](double x) {
+			double t{ std::clamp((x - x0) / (x1 - x0), 0.0, 1.0) };
+			return y0 + t * (y1 - y0);
+		};
+		ya = interpolate(i);
+		yb = interpolate(i + 1.0);
+	}
+	return {
+		(CellDir)std::floor(std::min(ya, yb)) - 1,
+		(CellDir)std::floor(std::max(ya, yb)) + 2
+	};
+}
+
+bool isCellCrossedBySegment(const Segment2& seg, const ArrayIndex& idx)
+{
+	auto cF{ buildCellFace(idx) };
+	if (CGAL::do_intersect(cF, seg)) {
+		auto intersection{ *CGAL::intersection(cF, seg) };
+		if (!boost::get<Point2 >(&intersection)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool isCellInsideTriangle(const Triangle2& t, const ArrayIndex& idx)
+{
+	for (const auto& di : { 0, 1 }) {
+		for (const auto& dj : { 0, 1 }) {
+			if (t.bounded_side(Point2(idx[0] + di, idx[1] + dj)) != CGAL::ON_BOUNDED_SIDE) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+std::vector<ArrayIndex> faceIntersections(const Polylines2& pls)
+{
+	std::vector<ArrayIndex> res;
+	if (pls.empty()) {
+		return res;
+	}
+
+	// Walks the columns covered by each segment and only tests the rows
+	// around it, the bounding box limits are kept to give the same set.
+	auto minMax{ buildMinAndMaxArrayIndices(getBoundingBox(pls)) };
+	std::set<ArrayIndex> crossed;
+	for (const auto& pl : pls) {
+		for (auto it{ pl.begin() }; std::next(it) != pl.end(); ++it) {
+			Segment2 seg{ *it, *std::next(it) };
+			auto bbox{ seg.bbox() };
+			CellDir iBegin{ std::max((CellDir)std::floor(bbox.xmin()) - 1, minMax[0][0]) };
+			CellDir iEnd{ std::min((CellDir)std::floor(bbox.xmax()) + 2, minMax[1][0]) };
+			for (CellDir i{ iBegin }; i < iEnd; ++i) {
+				auto [jBegin, jEnd] = buildColumnRowsRange(seg.source(), seg.target(), i);
+				jBegin = std::max(jBegin, minMax[0][1]);
+				jEnd = std::min(jEnd, minMax[1][1]);
+				for (CellDir j{ jBegin }; j < jEnd; ++j) {
+					const ArrayIndex idx{ i, j };
+					if (crossed.count(idx) == 0 && isCellCrossedBySegment(seg, idx)) {
+						crossed.insert(idx);
+					}
+				}
+			}
+		}
+	}
+	res.assign(crossed.begin(), crossed.end());
+	return res;
+}
+
+std::vector<ArrayIndex> faceIntersections(const Triangle2& t)
+{
+	std::vector<ArrayIndex> res;
+	if (t.is_degenerate()) {
+		std::cerr << "Triangle is degenerated:" << t << std::endl;
+		return res;
+	}
+
+	// Scans the triangle column by column. Cells with all their corners
+	// strictly inside are accepted directly, only cells close to the edges
+	// need the exact intersection test.
+	auto minMax{ buildMinAndMaxArrayIndices(t.bbox()) };
+	for (CellDir i{ minMax[0][0] }; i < minMax[1][0]; ++i) {
+		CellDir jBegin{ minMax[1][1] }, jEnd{ minMax[0][1] };
+		for (int e{ 0 }; e < 3; ++e) {
+			auto [b, f] = buildColumnRowsRange(t.vertex(e), t.vertex(e + 1), i);
+			if (b < f) {
+				jBegin = std::min(jBegin, b);
+				jEnd = std::max(jEnd, f);
+			}
+		}
+		jBegin = std::max(jBegin, minMax[0][1]);
+		jEnd = std::min(jEnd, minMax[1][1]);
+		for (CellDir j{ jBegin }; j < jEnd; ++j) {
+			const ArrayIndex idx{ i, j };
+			if (isCellInsideTriangle(t, idx) || isCellCrossedByTriangle(t, idx)) {
+				res.push_back(idx);
+			}
+		}
+	}
+	return res;
+}
+
 void mark_domains(
 	CDT& ct,
 	CDT::Face_handle start,
@@ -113,6 +331,45 @@ CDTs buildCDTsFromPolygonSet(const cgal::HPolygonSet& surfaces)
 	return r;
 }
 
+Triangle2 TriangleSoup::getTriangle(const Index& t) const
+{
+	const auto& vs{ triangles[t] };
+	return { getVertex(vs[0]), getVertex(vs[1]), getVertex(vs[2]) };
+}
+
+void appendToTriangleSoup(TriangleSoup& r, const CDT& cdt)
+{
+	std::unordered_map<const CDT::Vertex*, TriangleSoup::Index> indices;
+	for (const auto& f : cdt.finite_face_handles()) {
+		if (!f->info().in_domain()) {
+			continue;
+		}
+		assert(isValidFace(*f));
+		std::array<TriangleSoup::Index, 3> t;
+		for (int i{ 0 }; i < 3; ++i) {
+			const auto& v{ f->vertex(i) };
+			auto it{ indices.emplace(&*v, (TriangleSoup::Index)r.vertices.size()) };
+			if (it.second) {
+				r.vertices.push_back({ v->point().x(), v->point().y() });
+			}
+			t[i] = it.first->second;
+		}
+		r.triangles.push_back(t);
+	}
+}
+
+TriangleSoup buildTriangleSoup(const cgal::HPolygonSet& surfaces)
+{
+	// Triangulations are built one at a time and released once flattened.
+	TriangleSoup r;
+	for (const auto& pWH : surfaces.getPolygonsWithHoles()) {
+		appendToTriangleSoup(r, buildCDTFromPolygonWH(pWH));
+	}
+	r.vertices.shrink_to_fit();
+	r.triangles.shrink_to_fit();
+	return r;
+}
+
 HPolygonSet buildPolygonSetFromContour(const Polygons& contours)
 {
 	std::vector<const Polygon*> polygonsToJoin, polygonsToSubstract;
@@ -161,12 +418,12 @@ Polygons buildContourFromGraph(
 	return ps;
 }
 
-Polygons buildContourMap2(const std::vector<const CDT::Face*>& tris)
+Polygons buildContourMap2(const std::vector<Triangle2>& tris)
 {
 	boost::bimap<Point2, CoordinateId> pToId;
-	for (const auto& f : tris) {
+	for (const auto& t : tris) {
 		for (auto i{ 0 }; i < 3; ++i) {
-			const auto& v{ f->vertex(i)->point() };
+			const auto& v{ t.vertex(i) };
 			auto it{ pToId.left.find(v) };
 			if (it == pToId.left.end()) {
 				pToId.insert({ v, pToId.left.size() });
@@ -175,10 +432,10 @@ Polygons buildContourMap2(const std::vector<const CDT::Face*>& tris)
 	}
 	
 	utils::CoordGraph cG;
-	for (const auto& f : tris) {
+	for (const auto& t : tris) {
 		for (auto i{ 0 }; i < 3; ++i) {
-			auto vIt{ pToId.left.find(f->vertex(i)->point()) };
-			auto vNIt{ pToId.left.find(f->vertex((i+1)%3)->point()) };
+			auto vIt{ pToId.left.find(t.vertex(i)) };
+			auto vNIt{ pToId.left.find(t.vertex(i + 1)) };
 			assert(vIt != pToId.left.end());
 			assert(vNIt != pToId.left.end());
 			cG.addEdge(vIt->second, vNIt->second);
@@ -188,13 +445,79 @@ Polygons buildContourMap2(const std::vector<const CDT::Face*>& tris)
 	return buildContourFromGraph(cG, pToId);
 }
 
-HPolygonSet buildPolygonSetFromCDT(
-	const std::vector<const CDT::Face*>& tris)
+HPolygonSet buildPolygonSetFromTriangles(const std::vector<Triangle2>& tris)
 {
 	return buildPolygonSetFromContour(
 		buildContourMap2(tris));
 }
 
+HPolygonSet buildPolygonSetFromCDT(
+	const std::vector<const CDT::Face*>& tris)
+{
+	std::vector<Triangle2> ts;
+	ts.reserve(tris.size());
+	for (const auto& f : tris) {
+		ts.emplace_back(f->vertex(0)->point(), f->vertex(1)->point(), f->vertex(2)->point());
+	}
+	return buildPolygonSetFromTriangles(ts);
+}
+
+Polyline2 buildCellLineIntersection(
+	const Rectangle2& c,
+	const Polyline2& pl)
+{
+	Polyline2 r;
+	for (auto vIt{ pl.begin() }; std::next(vIt) != pl.end(); ++vIt) {
+		Segment2 s{ *vIt, *std::next(vIt) };
+		auto intResult{ CGAL::intersection(c, s) };
+		if (!intResult) {
+			continue;
+		};
+		if (const auto& p = boost::get<Segment2>(&*intResult)) {
+			if ((*p)[0] == (*p)[1]) {
+				continue;
+			}
+			if (r.empty()) {
+				r.push_back((*p)[0]);
+			}
+			r.push_back((*p)[1]);
+		}
+	}
+	return r;
+}
+
+FaceFilling buildFaceFilling(
+	const FillingState& state,
+	const ArrayIndex& idx,
+	const PrTriangles& tris,
+	const PrPolylines& lins)
+{
+	FaceFilling r;
+	const auto cellFacePolygon{ buildCellFacePolygon(idx) };
+	if (state.full()) {
+		r.tris.emplace(state.getPriority(), HPolygonSet{ cellFacePolygon });
+	}
+	else {
+		for (const auto& [pr, ts] : tris) {
+			auto trisInFace{ buildPolygonSetFromTriangles(ts) };
+			assert(trisInFace.do_intersect(cellFacePolygon));
+			trisInFace.intersection(cellFacePolygon);
+			r.tris.emplace(pr, trisInFace);
+		}
+	}
+
+	const auto cellFace{ buildCellFace(idx) };
+	for (const auto& [pr, pls] : lins) {
+		for (const auto& pl : pls) {
+			auto p{ buildCellLineIntersection(cellFace, pl) };
+			if (!p.empty()) {
+				r.lins[pr].push_back(p);
+			}
+		}
+	}
+	return r;
+}
+
 Polygons buildContourMap3(const Polyhedron& p, const Axis& x)
 {
 	boost::bimap<Point2, CoordinateId> pToId;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "types/CellIndex.h"
+#include "FillingRaster.h"
 #include "cgal/PolyhedronTools.h"
 #include "cgal/HPolygonSet.h"
 #include "cgal/Tools.h"
@@ -13,6 +14,45 @@ namespace tessellator {
 namespace filler {
 
 using Height = cgal::KType;
+using Fractions = std::map<Priority, double>;
+using PrTriangles = std::map<Priority, std::vector<cgal::Triangle2>>;
+using PrPolylines = std::map<Priority, cgal::Polylines2>;
+
+struct FaceFilling {
+	std::map<Priority, cgal::Polylines2> lins;
+	std::map<Priority, cgal::HPolygonSet> tris;
+
+	bool operator==(const FaceFilling& rhs) const {
+		return lins == rhs.lins 
+			&& tris == rhs.tris;
+	}
+
+	cgal::HPolygonSet allSurfaces() const { 
+		cgal::HPolygonSet res;
+		for (const auto& t: tris) {
+			res.join(t.second);
+		}
+		return res;
+	}
+	cgal::HPolygonSet metalSurfaces() const { 
+		cgal::HPolygonSet res;
+		for (const auto& [pr, pols] : tris) {
+			if (pr > 0) {
+				res.join(pols);
+			}
+		}
+		return res;
+	}
+	cgal::HPolygonSet dielectricSurfaces() const { 
+		cgal::HPolygonSet res;
+		for (const auto& [pr, pols] : tris) {
+			if (pr < 0) {
+				res.join(pols);
+			}
+		}
+		return res;
+	}
+};
 
 struct FaceInfo2
 {
@@ -31,18 +71,43 @@ using TDS = CGAL::Triangulation_data_structure_2<Vb, Fb>;
 using CDT = CGAL::Constrained_Delaunay_triangulation_2<cgal::K, TDS, Itag>;
 using CDTs = std::vector<CDT>;
 
+// In domain triangles of a set of triangulations. Vertices are shared by
+// the triangles and stored without the triangulation data structure.
+struct TriangleSoup {
+	using Index = std::uint32_t;
+
+	std::vector<std::array<double, 2>> vertices;
+	std::vector<std::array<Index, 3>> triangles;
+
+	bool empty() const { return triangles.empty(); }
+	std::size_t size() const { return triangles.size(); }
+	cgal::Point2 getVertex(const Index& v) const { return cgal::Point2(vertices[v][0], vertices[v][1]); }
+	cgal::Triangle2 getTriangle(const Index&) const;
+};
 
 bool isCellCrossedByTriangle(const cgal::Triangle2&, const ArrayIndex&);
+bool isCellCrossedBySegment(const cgal::Segment2&, const ArrayIndex&);
+// Faces crossed by the polylines or overlapped by the triangle, limited to
+// the faces in their bounding box.
+std::vector<ArrayIndex> faceIntersections(const cgal::Polylines2&);
+std::vector<ArrayIndex> faceIntersections(const cgal::Triangle2&);
 cgal::Rectangle2 buildCellFace(const ArrayIndex&);
 cgal::Polygon buildCellFacePolygon(const ArrayIndex&);
+double computeCellFaceOverlapArea(const cgal::Triangle2&, const ArrayIndex&);
 
 bool isValidFace(const CDT::Face& f);
 
 cgal::HPolygonSet buildPolygonSetFromCDT(
 	const std::vector<const CDT::Face*>& tris);
+cgal::HPolygonSet buildPolygonSetFromTriangles(const std::vector<cgal::Triangle2>&);
+cgal::Polyline2 buildCellLineIntersection(const cgal::Rectangle2&, const cgal::Polyline2&);
+// Full faces are covered by their priority, otherwise the triangles of each
+// priority are intersected with the face. Lines are cut in any state.
+FaceFilling buildFaceFilling(const FillingState&, const ArrayIndex&, const PrTriangles&, const PrPolylines&);
 
 CDT buildCDTFromPolygonWH(const cgal::PolygonWH&);
 CDTs buildCDTsFromPolygonSet(const cgal::HPolygonSet&);
+TriangleSoup buildTriangleSoup(const cgal::HPolygonSet&);
 
 cgal::HPolygonSet buildPolygonSetFromPolyhedron(
 	const cgal::Polyhedron& p, const Axis& x);
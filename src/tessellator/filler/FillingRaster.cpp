@@ -0,0 +1,219 @@
+#include "FillingRaster.h"
+
+#include <algorithm>
+#include <cassert>
+#include <set>
+#include <stdexcept>
+
+namespace meshlib {
+namespace tessellator {
+namespace filler {
+
+FillingState::FillingState(const FillingType& t) :
+	type{ t },
+	priority_{ 0 }
+{
+	assert(t != FillingType::Full);
+}
+
+FillingState::FillingState(const Priority& p) :
+	type{FillingType::Full},
+	priority_{p}
+{}
+
+Priority FillingState::getPriority() const
+{
+	assert(type == FillingType::Full);
+	return priority_;
+}
+
+FillingRaster::Code FillingRaster::encode(const FillingState& s)
+{
+	if (!s.full()) {
+		return (Code)s.type;
+	}
+	auto it{ std::find(priorities_.begin(), priorities_.end(), s.getPriority()) };
+	if (it == priorities_.end()) {
+		if (priorities_.size() >= (1 << 14)) {
+			throw std::runtime_error("Too many priorities in filling raster.");
+		}
+		it = priorities_.insert(priorities_.end(), s.getPriority());
+	}
+	return (Code)(((it - priorities_.begin()) << 2) | (Code)FillingType::Full);
+}
+
+FillingRaster::Spans buildSpans(const FillingRaster::States& states)
+{
+	FillingRaster::Spans res;
+	res.reserve(states.size());
+	for (const auto& [idx, s] : states) {
+		res.push_back({ idx[0], idx[1], idx[1] + 1, s });
+	}
+	return res;
+}
+
+FillingRaster::FillingRaster(const States& states) :
+	FillingRaster(buildSpans(states))
+{}
+
+FillingRaster::FillingRaster(const Spans& spans)
+{
+	std::vector<std::size_t> ids;
+	for (std::size_t s{ 0 }; s < spans.size(); ++s) {
+		if (!spans[s].state.empty() && spans[s].begin < spans[s].end) {
+			ids.push_back(s);
+		}
+	}
+	if (ids.empty()) {
+		return;
+	}
+	std::sort(ids.begin(), ids.end(),
+		[&](const auto& lhs, const auto& rhs) {
+			return std::make_pair(spans[lhs].row, spans[lhs].begin) <
+				std::make_pair(spans[rhs].row, spans[rhs].begin);
+		}
+	);
+
+	firstRow_ = spans[ids.front()].row;
+	const CellDir lastRow{ spans[ids.back()].row };
+	rowBegins_.reserve(lastRow - firstRow_ + 2);
+	rowBegins_.push_back(0);
+	CellDir row{ firstRow_ };
+	for (auto first{ ids.begin() }; first != ids.end(); ) {
+		const CellDir spanRow{ spans[*first].row };
+		auto last{ std::find_if(first, ids.end(),
+			[&](const auto& s) { return spans[s].row != spanRow; }
+		) };
+		for (; row < spanRow; ++row) {
+			rowBegins_.push_back(runs_.size());
+		}
+		appendRow(spans, std::vector<std::size_t>(first, last));
+		first = last;
+	}
+	for (; row <= lastRow; ++row) {
+		rowBegins_.push_back(runs_.size());
+	}
+	runs_.shrink_to_fit();
+}
+
+void FillingRaster::appendRow(const Spans& spans, const std::vector<std::size_t>& ids)
+{
+	std::vector<CellDir> bounds;
+	for (const auto& s : ids) {
+		bounds.push_back(spans[s].begin);
+		bounds.push_back(spans[s].end);
+	}
+	std::sort(bounds.begin(), bounds.end());
+	bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+	// Sweeps the row keeping the spans covering each interval between
+	// bounds, ordered as given. Finished spans are dropped lazily.
+	std::set<std::size_t> active;
+	auto next{ ids.begin() };
+	for (std::size_t b{ 0 }; b + 1 < bounds.size(); ++b) {
+		for (; next != ids.end() && spans[*next].begin == bounds[b]; ++next) {
+			active.insert(*next);
+		}
+		while (!active.empty() && spans[*active.begin()].end <= bounds[b]) {
+			active.erase(active.begin());
+		}
+		if (active.empty()) {
+			continue;
+		}
+		const Code code{ encode(spans[*active.begin()].state) };
+		if (runs_.size() > rowBegins_.back() &&
+			runs_.back().end == bounds[b] && runs_.back().code == code) {
+			runs_.back().end = bounds[b + 1];
+		}
+		else {
+			runs_.push_back({ bounds[b], bounds[b + 1], code });
+		}
+	}
+}
+
+FillingRaster::View FillingRaster::getView() const
+{
+	View res;
+	res.firstRow = firstRow_;
+	res.numberOfRows = rowBegins_.empty() ? 0 : rowBegins_.size() - 1;
+	res.rowBegins = rowBegins_.data();
+	res.runs = runs_.data();
+	res.priorities = priorities_.data();
+	return res;
+}
+
+FillingState FillingRaster::View::getFillingState(const ArrayIndex& idx) const
+{
+	const CellDir row{ idx[0] - firstRow };
+	if (row < 0 || row >= (CellDir)numberOfRows) {
+		return FillingState{ FillingType::Empty };
+	}
+	const auto begin{ runs + rowBegins[row] };
+	const auto end{ runs + rowBegins[row + 1] };
+	auto it{ std::upper_bound(begin, end, idx[1],
+		[](const CellDir& j, const Run& r) { return j < r.begin; }
+	) };
+	if (it == begin || idx[1] >= std::prev(it)->end) {
+		return FillingState{ FillingType::Empty };
+	}
+	return decode(std::prev(it)->code);
+}
+
+FillingState FillingRaster::View::decode(const Code& code) const
+{
+	const FillingType type{ (FillingType)(code & 3) };
+	if (type == FillingType::Full) {
+		return FillingState{ priorities[code >> 2] };
+	}
+	return FillingState{ type };
+}
+
+FillingState FillingRaster::getFillingState(const ArrayIndex& idx) const
+{
+	return getView().getFillingState(idx);
+}
+
+void FillingRaster::fill(std::vector<FillingState>& res, const ArrayIndex& size) const
+{
+	res.assign(std::size_t(size[0]) * size[1], FillingState{ FillingType::Empty });
+	const auto view{ getView() };
+	const CellDir lastRow{ firstRow_ + (CellDir)rowBegins_.size() - 1 };
+	for (CellDir i{ std::max(firstRow_, 0) }; i < std::min(lastRow, size[0]); ++i) {
+		const std::size_t row{ std::size_t(i - firstRow_) };
+		const std::size_t offset{ std::size_t(i) * size[1] };
+		for (std::size_t r{ rowBegins_[row] }; r < rowBegins_[row + 1]; ++r) {
+			const auto& run{ runs_[r] };
+			const CellDir begin{ std::max(run.begin, 0) };
+			const CellDir end{ std::min(run.end, size[1]) };
+			if (begin >= end) {
+				continue;
+			}
+			std::fill(res.begin() + offset + begin, res.begin() + offset + end, view.decode(run.code));
+		}
+	}
+}
+
+std::vector<std::vector<ArrayIndex>> FillingRaster::getRows(const FillingType& type) const
+{
+	std::vector<std::vector<ArrayIndex>> res;
+	for (std::size_t row{ 0 }; row + 1 < rowBegins_.size(); ++row) {
+		std::vector<ArrayIndex> faces;
+		for (std::size_t r{ rowBegins_[row] }; r < rowBegins_[row + 1]; ++r) {
+			const auto& run{ runs_[r] };
+			if ((FillingType)(run.code & 3) != type) {
+				continue;
+			}
+			for (CellDir j{ run.begin }; j < run.end; ++j) {
+				faces.push_back({ firstRow_ + (CellDir)row, j });
+			}
+		}
+		if (!faces.empty()) {
+			res.push_back(std::move(faces));
+		}
+	}
+	return res;
+}
+
+}
+}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "types/CellIndex.h"
+
+#include <cstdint>
+
+namespace meshlib {
+namespace tessellator {
+namespace filler {
+
+enum class FillingType {
+	Empty,
+	Partial,
+	Full
+};
+
+class FillingState {
+public:
+	FillingType type;
+
+	FillingState(const FillingType& t);
+	FillingState(const Priority& p);
+	Priority getPriority() const;
+
+	bool empty() const { return type == FillingType::Empty; }
+	bool partial() const { return type == FillingType::Partial; }
+	bool full() const { return type == FillingType::Full; }
+private:
+	Priority priority_;
+};
+
+// Filling states of the faces of a slice. Consecutive faces of a row with 
+// the same state are stored as a single run, faces out of any run are empty.
+class FillingRaster {
+public:
+	using States = std::vector<std::pair<ArrayIndex, FillingState>>;
+	// Faces of row from begin to end, not included.
+	struct Span {
+		CellDir row;
+		CellDir begin;
+		CellDir end;
+		FillingState state;
+	};
+	using Spans = std::vector<Span>;
+
+	// Two bits of filling type followed by the index of the priority.
+	using Code = std::uint16_t;
+	struct Run {
+		CellDir begin;
+		CellDir end;
+		Code code;
+	};
+
+	// Raster arrays, owned by a raster or mapped from a file.
+	struct View {
+		CellDir firstRow{ 0 };
+		std::size_t numberOfRows{ 0 };
+		const std::uint64_t* rowBegins{ nullptr };
+		const Run* runs{ nullptr };
+		const Priority* priorities{ nullptr };
+
+		FillingState getFillingState(const ArrayIndex&) const;
+		FillingState decode(const Code&) const;
+	};
+
+	FillingRaster() = default;
+	FillingRaster(const States&);
+	// Where spans overlap, the state of the one given first is kept.
+	FillingRaster(const Spans&);
+
+	FillingState getFillingState(const ArrayIndex&) const;
+	// Writes the states of the faces from { 0, 0 } to size, row major.
+	void fill(std::vector<FillingState>&, const ArrayIndex& size) const;
+	// Faces of a filling type grouped by rows, in raster order.
+	std::vector<std::vector<ArrayIndex>> getRows(const FillingType&) const;
+	std::size_t numberOfRuns() const { return runs_.size(); }
+	std::size_t numberOfPriorities() const { return priorities_.size(); }
+	View getView() const;
+
+private:
+	CellDir firstRow_{ 0 };
+	std::vector<std::uint64_t> rowBegins_;
+	std::vector<Run> runs_;
+	std::vector<Priority> priorities_;
+
+	Code encode(const FillingState&);
+	void appendRow(const Spans&, const std::vector<std::size_t>& ids);
+};
+
+}
+}
+}
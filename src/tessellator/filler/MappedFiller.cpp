@@ -0,0 +1,70 @@
+#include "MappedFiller.h"
+
+namespace meshlib {
+namespace tessellator {
+namespace filler {
+
+MappedFiller::MappedFiller(const std::string& path) :
+	file_{ path }
+{}
+
+FillingState MappedFiller::getFillingState(const CellIndex& c) const
+{
+	return file_.getRaster(c.axis, c.getSliceNumber()).getFillingState(c.getArrayIndex());
+}
+
+FaceFilling MappedFiller::getFaceFilling(const CellIndex& c) const
+{
+	const auto idx{ c.getArrayIndex() };
+	const auto state{ getFillingState(c) };
+	PrTriangles tris;
+	PrPolylines lins;
+	if (const auto* face{ file_.findFace(c.axis, c.getSliceNumber(), idx) }) {
+		if (!state.full()) {
+			for (const auto& t : file_.getTriangles(*face)) {
+				const auto& cs{ t.coordinates };
+				tris[t.priority].emplace_back(
+					Point2(cs[0], cs[1]), Point2(cs[2], cs[3]), Point2(cs[4], cs[5]));
+			}
+		}
+		for (const auto& s : file_.getSegments(*face)) {
+			const auto& cs{ s.coordinates };
+			lins[s.priority].push_back({ Point2(cs[0], cs[1]), Point2(cs[2], cs[3]) });
+		}
+	}
+	return buildFaceFilling(state, idx, tris, lins);
+}
+
+EdgeFilling MappedFiller::getEdgeFilling(const CellIndex& c) const
+{
+	const auto* line{ file_.findLine(c.axis, c.getArrayIndex()) };
+	if (line == nullptr) {
+		return EdgeFilling();
+	}
+	PrSegmentsMap prSeg;
+	for (const auto& s : file_.getSegments(*line)) {
+		prSeg[s.priority].push_back(s.ends);
+	}
+	return buildEdgeFilling(prSeg, c.getSliceNumber());
+}
+
+Fractions MappedFiller::getAreaFractions(const CellIndex& c) const
+{
+	const auto state{ getFillingState(c) };
+	if (state.full()) {
+		return { { state.getPriority(), 1.0 } };
+	}
+	const auto* face{ file_.findFace(c.axis, c.getSliceNumber(), c.getArrayIndex()) };
+	if (face == nullptr) {
+		return Fractions();
+	}
+	Fractions res;
+	for (const auto& f : file_.getFractions(*face)) {
+		res.emplace(f.priority, f.value);
+	}
+	return res;
+}
+
+}
+}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Slice.h"
+#include "SegmentsArray.h"
+#include "FillerFile.h"
+
+namespace meshlib {
+namespace tessellator {
+namespace filler {
+
+// Read only filler mapped from a file written by Filler::save. Queries are
+// answered from the mapped records, giving the same results as the filler
+// which was saved.
+class MappedFiller {
+public:
+	MappedFiller(const std::string& path);
+
+	EdgeFilling getEdgeFilling(const CellIndex&) const;
+	FaceFilling getFaceFilling(const CellIndex&) const;
+	FillingState getFillingState(const CellIndex&) const;
+	Fractions getAreaFractions(const CellIndex&) const;
+
+private:
+	fillerFile::MappedFile file_;
+};
+
+}
+}
+}
@@ -1,5 +1,7 @@
 #include "SegmentsArray.h"
 
+#include <limits>
+
 namespace meshlib {
 namespace tessellator {
 namespace filler {
@@ -36,11 +38,11 @@ bool doOverlap(const Segment1& q, const Segment1& s)
 	return true;
 }
 
-EdgeFilling Segments::getEdgeFilling(const CellDir& c) const 
+EdgeFilling buildEdgeFilling(const PrSegmentsMap& prSeg, const CellDir& c)
 {
 	auto q{ buildCellEdge(c) };
 	EdgeFilling res;
-	for (const auto& [pr, segs] : prSeg_) {
+	for (const auto& [pr, segs] : prSeg) {
 		for (const auto& s : segs) {
 			if (doOverlap(q, s)) {
 				auto lin{ buildSegmentE1FromOverlap(q, s) };
@@ -53,6 +55,58 @@ EdgeFilling Segments::getEdgeFilling(const CellDir& c) const
 	return res;
 }
 
+EdgeFilling Segments::getEdgeFilling(const CellDir& c) const 
+{
+	return buildEdgeFilling(prSeg_, c);
+}
+
+Fractions Segments::getLengthFractions(const CellDir& c) const
+{
+	Fractions res;
+	for (const auto& [pr, fractions] : lengthFractions_) {
+		const CellDir i{ c - firstCell_ };
+		if (i >= 0 && i < (CellDir)fractions.size() && fractions[i] > 0.0) {
+			res.emplace(pr, fractions[i]);
+		}
+	}
+	return res;
+}
+
+void Segments::buildLengthFractions()
+{
+	lengthFractions_.clear();
+	CellDir lastCell{ std::numeric_limits<CellDir>::min() };
+	firstCell_ = std::numeric_limits<CellDir>::max();
+	for (const auto& [pr, segs] : prSeg_) {
+		for (const auto& s : segs) {
+			firstCell_ = std::min(firstCell_, (CellDir)std::floor(std::min(s[0], s[1])));
+			lastCell = std::max(lastCell, (CellDir)std::ceil(std::max(s[0], s[1])));
+		}
+	}
+	if (lastCell <= firstCell_) {
+		firstCell_ = 0;
+		return;
+	}
+
+	for (const auto& [pr, segs] : prSeg_) {
+		auto& fractions{ lengthFractions_[pr] };
+		fractions.assign(lastCell - firstCell_, 0.0);
+		for (const auto& s : segs) {
+			const KType ini{ std::min(s[0], s[1]) };
+			const KType end{ std::max(s[0], s[1]) };
+			for (CellDir c{ (CellDir)std::floor(ini) }; c < end; ++c) {
+				const double length{ std::min(end, KType(c + 1)) - std::max(ini, KType(c)) };
+				if (length > 0.0) {
+					fractions[c - firstCell_] += length;
+				}
+			}
+		}
+		for (auto& f : fractions) {
+			f = std::min(f, 1.0);
+		}
+	}
+}
+
 bool pointIsInSegment(
 	const Point1 & p,
 	const Segment1 & s)
@@ -17,13 +17,22 @@ struct EdgeFilling {
 	}
 };
 
+// Pieces of the segments overlapping the edge of the grid line at cell.
+EdgeFilling buildEdgeFilling(const PrSegmentsMap&, const CellDir& cell);
+
 class Segments {
 public:
 	EdgeFilling getEdgeFilling(const CellDir&) const;
+	Fractions getLengthFractions(const CellDir&) const;
+	const PrSegmentsMap& getSegments() const { return prSeg_; }
 
 	void add(const Priority& p, const Segments1& s);
+	void buildLengthFractions();
 private:
 	PrSegmentsMap prSeg_;
+
+	CellDir firstCell_{ 0 };
+	std::map<Priority, std::vector<double>> lengthFractions_;
 };
 
 }
@@ -1,4 +1,5 @@
 #include "Slice.h"
+#include "FillerFile.h"
 
 #include <CGAL/Boolean_set_operations_2.h>
 
@@ -8,13 +9,14 @@
 #include <CGAL/AABB_traits.h>
 #include <CGAL/AABB_face_graph_triangle_primitive.h>
 
+#include <algorithm>
+#include <set>
+
 
 namespace meshlib {
 namespace tessellator {
 namespace filler {
 
-using Bbox2 = CGAL::Bbox_2;
-
 using cgal::tools::buildCoordinateFromPoint2;
 using cgal::tools::removeCollinears;
 
@@ -60,117 +62,6 @@ Polylines2 removeSegmentsContainedInAnyAxis(const Polyline2& p)
 	return res;
 }
 
-std::array<ArrayIndex, 2> buildMinAndMaxArrayIndices(const Bbox2& bbox)
-{
-	ArrayIndex minAI{
-		std::numeric_limits<CellDir>::max(),
-		std::numeric_limits<CellDir>::max()
-	};
-	ArrayIndex maxAI{
-		std::numeric_limits<CellDir>::min(),
-		std::numeric_limits<CellDir>::min()
-	};
-	for (auto d{ 0 }; d < 2; ++d) {
-		if ((CellDir)std::floor(bbox.min(d)) < minAI[d]) {
-			minAI[d] = (CellDir)std::floor(bbox.min(d));
-		}
-		if ((CellDir)std::floor(bbox.max(d)) > maxAI[d]) {
-			maxAI[d] = (CellDir)std::ceil(bbox.max(d));
-		}
-	}
-	return { minAI, maxAI };
-}
-
-bool isCellCrossedByPolylines(const Polylines2& pls, const ArrayIndex& idx) 
-{
-	auto cF{ buildCellFace(idx) };
-	for (const auto& pl : pls) {
-		for (auto it{ pl.begin() }; std::next(it) != pl.end(); ++it) {
-			Segment2 seg{ *it, *std::next(it) };
-			if (CGAL::do_intersect(cF, seg)) {
-				auto intersection{*CGAL::intersection(cF, seg)};
-				if (!boost::get<Point2 >(&intersection)) {
-					return true;
-				}
-			}
-		}
-	}
-	return false;
-}
-
-Bbox2 getBoundingBox(const Polylines2& pls) 
-{
-	assert(!pls.empty());
-
-	std::array<KType, 2> min{
-		std::numeric_limits<KType>::max(),
-		std::numeric_limits<KType>::max()
-	};
-	std::array<KType, 2> max{
-		std::numeric_limits<KType>::min(),
-		std::numeric_limits<KType>::min()
-	};
-	for (const auto& pl : pls) {
-		assert(!pl.empty());
-		for (const auto& p : pl) {
-			for (int d{ 0 }; d < 2; d++) {
-				if (p.cartesian(d) < min[d]) {
-					min[d] = p.cartesian(d);
-				}
-				if (p.cartesian(d) > max[d]) {
-					max[d] = p.cartesian(d);
-				}
-			}
-		}
-	}
-	return Bbox2{ 
-		CGAL::to_double(min[X]), 
-		CGAL::to_double(min[Y]), 
-		CGAL::to_double(max[X]), 
-		CGAL::to_double(max[Y]) 
-	};
-}
-
-std::vector<ArrayIndex> faceIntersections(const Polylines2& pls)
-{
-	std::vector<ArrayIndex> res;
-	if (pls.empty()) {
-		return res;
-	}
-
-	auto minMax{ buildMinAndMaxArrayIndices(getBoundingBox(pls)) };
-	res.reserve(minMax.size());
-	for (int i{ minMax[0][0]}; i < minMax[1][0]; ++i) {
-		for (int j{ minMax[0][1]}; j < minMax[1][1]; ++j) {
-			const ArrayIndex idx{ i, j };
-			if (isCellCrossedByPolylines(pls, idx)) {
-				res.push_back(idx);
-			}
-		}
-	}
-	return res;
-}
-
-std::vector<ArrayIndex> faceIntersections(const Triangle2& t)
-{
-	std::vector<ArrayIndex> res;
-	if (t.is_degenerate()) {
-		std::cerr << "Triangle is degenerated:" << t << std::endl;
-		return res;
-	}
-	auto minMax{ buildMinAndMaxArrayIndices(t.bbox()) };
-	res.reserve(minMax.size());
-	for (int i{ minMax[0][0] }; i < minMax[1][0]; ++i) {
-		for (int j{ minMax[0][1]}; j < minMax[1][1]; ++j) {
-			const ArrayIndex idx{ i, j };
-			if (isCellCrossedByTriangle(t, idx)) {
-				res.push_back(idx);
-			}
-		}
-	}
-	return res;
-}
-
 void updateContourIndex(Slice::ContourIndexSet& cIS, const Polyline2& p)
 {
 	auto nonAligned{ faceIntersections(removeSegmentsContainedInAnyAxis(p)) };
@@ -190,31 +81,20 @@ void Slice::add(const Polylines2& polylines, const Priority& pr)
 	}
 }
 
-FillingState::FillingState(const FillingType& t) :
-	type{ t },
-	priority_{ 0 }
-{
-	assert(t != FillingType::Full);
-}
-
-FillingState::FillingState(const Priority& p) :
-	type{FillingType::Full},
-	priority_{p}
-{}
-
-Priority FillingState::getPriority() const
-{
-	assert(type == FillingType::Full);
-	return priority_;
-}
-
-void Slice::removeInSuperiorPriorities(const Priority& pr)
+void Slice::resolvePriorities()
 {
-	for (auto& [p, s] : data_) {
-		if (pr < p) {
-			data_[pr].surfaces.difference(s.surfaces);
-			data_[pr].surfaces = data_[pr].surfaces;
+	// Clipping by the union of higher priorities gives the same sets as
+	// clipping by each of them, with one difference per priority.
+	HPolygonSet higher;
+	for (auto it{ data_.rbegin() }; it != data_.rend(); ++it) {
+		auto& surfaces{ it->second.surfaces };
+		if (surfaces.isEmpty()) {
+			continue;
+		}
+		if (!higher.isEmpty()) {
+			surfaces.difference(higher);
 		}
+		higher.join(surfaces);
 	}
 }
 
@@ -246,7 +126,6 @@ void Slice::addAsPolygon(const Polylines2& polylines, const Priority& pr)
 	for (const auto& polygon : holes) {
 		sd.surfaces.difference(polygon);
 	}
-	removeInSuperiorPriorities(pr);
 }
 
 Polyline2 buildPolylineFromPolygon(const Polygon& p)
@@ -264,8 +143,6 @@ void Slice::add(const HPolygonSet& polygons, const Priority& pr)
 
 	SliceData& sd = data_[pr];
 	sd.surfaces.join(polygons);
-
-	removeInSuperiorPriorities(pr);
 }
 
 void Slice::mergeLines(const Slice& lhs)
@@ -279,55 +156,6 @@ void Slice::mergeLines(const Slice& lhs)
 	contourFlag = lhs.nonEdgeAlignedContourIndices_;
 }
 
-TriV buildTriVFromFace(const CDT::Face f, Axis x, Height h) {
-	TriV tri;
-	for (int i = 0; i < 3; i++) {
-		tri[i] = buildCoordinateFromPoint2(
-			f.vertex(i)->point(), h, x);
-	}
-	return tri;
-}
-
-Triangle2 buildTriangle2FromFace(const CDT::Face& f)
-{
-	std::vector<Point2> v(3);
-	for (int i{ 0 }; i < 3; ++i) {
-		v[i] = f.vertex(i)->point();
-	}
-	return { v[0], v[1], v[2] };
-}
-
-TriVs buildTriVsFromTriangulation(const CDT& cdt, Axis x, Height h)
-{
-	TriVs res;
-	res.reserve(cdt.number_of_faces());
-
-	for (const auto& f : cdt.finite_face_handles()) {
-		if (f->info().in_domain()) {
-			res.push_back(buildTriVFromFace(*f, x, h));
-		}
-	}
-	return res;
-}
-
-LinVs buildLinVsFromPolyline(
-	const std::vector<Polyline2>& pls,
-	Axis axis,
-	double height)
-{
-	LinVs res;
-	for (const auto& pl : pls) {
-		for (auto vIt{ pl.begin() }; std::next(vIt) != pl.end(); ++vIt) {
-			LinV lin{
-				buildCoordinateFromPoint2(*vIt,            height, axis),
-				buildCoordinateFromPoint2(*std::next(vIt), height, axis),
-			};
-			res.push_back(lin);
-		}
-	}
-	return res;
-}
-
 Polygon buildPolygonFromFaceTriIntersection(
 	const Rectangle2& i2, const Triangle2& t2)
 {
@@ -350,30 +178,6 @@ Polygon buildPolygonFromFaceTriIntersection(
 	return r;
 }
 
-Polyline2 buildCellLineIntersection(
-	const Rectangle2& c,
-	const Polyline2& pl)
-{
-	Polyline2 r;
-	for (auto vIt{ pl.begin() }; std::next(vIt) != pl.end(); ++vIt) {
-		Segment2 s{ *vIt, *std::next(vIt) };
-		auto intResult{ CGAL::intersection(c, s) };
-		if (!intResult) {
-			continue;
-		};
-		if (const auto& p = boost::get<Segment2>(&*intResult)) {
-			if ((*p)[0] == (*p)[1]) {
-				continue;
-			}
-			if (r.empty()) {
-				r.push_back((*p)[0]);
-			}
-			r.push_back((*p)[1]);
-		}
-	}
-	return r;
-}
-
 void Slice::SliceData::buildLineMaps()
 {
 	for (const auto& l : lines) {
@@ -388,16 +192,26 @@ void Slice::SliceData::buildLineMaps()
 	}
 }
 
-void Slice::SliceData::buildSurfaceMaps()
+void Slice::SliceData::buildSurfaceMaps(
+	const ContourIndexSet& partials,
+	const Priority& pr,
+	FillingRaster::Spans& fulls)
 {
-	for (const auto& triangulation : triangulations) {
-		for (const auto& f : triangulation.finite_face_handles()) {
-			if (!f->info().in_domain()) {
+	// Faces are visited column by column, so consecutive full faces of a
+	// triangle extend the last span.
+	for (TriangleSoup::Index t{ 0 }; t < triangles.size(); ++t) {
+		const std::size_t firstSpan{ fulls.size() };
+		for (const auto& idx : faceIntersections(triangles.getTriangle(t))) {
+			if (partials.count(idx) != 0) {
+				trianglesMaps[idx].push_back(t);
 				continue;
 			}
-			for (const auto& idx : faceIntersections(buildTriangle2FromFace(*f))) {
-				assert(isValidFace(*f));
-				trianglesMaps[idx].push_back(&*f);
+			if (fulls.size() > firstSpan &&
+				fulls.back().row == idx[0] && fulls.back().end == idx[1]) {
+				fulls.back().end++;
+			}
+			else {
+				fulls.push_back({ idx[0], idx[1], idx[1] + 1, FillingState{ pr } });
 			}
 		}
 	}
@@ -408,19 +222,13 @@ bool Slice::SliceData::isEmpty() const
 	return
 		lines.size() == 0 &&
 		surfaces.size() == 0 &&
-		triangulations.size() == 0;
-}
-
-void Slice::SliceData::buildMaps()
-{
-	buildSurfaceMaps();
-	buildLineMaps();
+		triangles.empty();
 }
 
 void Slice::buildTriangulations()
 {
 	for (auto& [pr, sd] : data_) {
-		sd.triangulations = buildCDTsFromPolygonSet(sd.surfaces);
+		sd.triangles = buildTriangleSoup(sd.surfaces);
 	}
 }
 
@@ -450,10 +258,6 @@ void Slice::cleanSurfaces()
 
 void Slice::buildSearchMap() 
 {
-	for (auto& it : data_) {
-		it.second.buildMaps();
-	}
-
 	for (const auto& it : data_) {
 		for (const auto& pwh : it.second.surfaces.getPolygonsWithHoles()) {
 			updateContourIndex(nonEdgeAlignedContourIndices_,
@@ -467,46 +271,75 @@ void Slice::buildSearchMap()
 			updateContourIndex(nonEdgeAlignedContourIndices_, pl);
 		}
 	}
+
+	// Contours make faces partial, otherwise the lowest priority wins.
+	FillingRaster::Spans spans;
+	for (const auto& idx : nonEdgeAlignedContourIndices_) {
+		spans.push_back({ idx[0], idx[1], idx[1] + 1, FillingState{ FillingType::Partial } });
+	}
+	for (auto& [pr, sd] : data_) {
+		sd.buildSurfaceMaps(nonEdgeAlignedContourIndices_, pr, spans);
+		sd.buildLineMaps();
+	}
+	fillingRaster_ = FillingRaster{ spans };
+	nonEdgeAlignedContourIndices_.clear();
+
+	buildAreaFractions();
 }
 
-void Slice::fillSurfaces(
-	FaceFilling& r,
-	const ArrayIndex& idx) const
+void Slice::buildAreaFractions()
 {
-	//assert(getFillingState(idx).partial());
-	for (auto& [pr, sd] : data_) {
-		const auto& surface{ sd.triangulations };
-		const auto& searchMap{ sd.trianglesMaps };
-		auto it{ searchMap.find(idx) };
-		if (it == searchMap.end()) {
+	// Triangles of a priority do not overlap, so their areas add up.
+	for (const auto& row : fillingRaster_.getRows(FillingType::Partial)) {
+		for (const auto& idx : row) {
+			Fractions fractions;
+			for (const auto& [pr, sd] : data_) {
+				auto it{ sd.trianglesMaps.find(idx) };
+				if (it == sd.trianglesMaps.end()) {
+					continue;
+				}
+				double area{ 0.0 };
+				for (const auto& t : it->second) {
+					area += computeCellFaceOverlapArea(sd.triangles.getTriangle(t), idx);
+				}
+				if (area > 0.0) {
+					fractions[pr] = std::min(area, 1.0);
+				}
+			}
+			if (!fractions.empty()) {
+				partialAreaFractions_.emplace(idx, std::move(fractions));
+			}
+		}
+	}
+}
+
+void Slice::collectTriangles(PrTriangles& r, const ArrayIndex& idx) const
+{
+	for (const auto& [pr, sd] : data_) {
+		auto it{ sd.trianglesMaps.find(idx) };
+		if (it == sd.trianglesMaps.end()) {
 			// This may happen when a cell is crossed by 
 			// a polyline but does not contain surfaces.
 			continue;
 		}
-		auto trisInFace{ buildPolygonSetFromCDT(it->second) };
-		auto cellFacePolygon{ buildCellFacePolygon(idx) };
-		assert(trisInFace.do_intersect(cellFacePolygon));
-		trisInFace.intersection(cellFacePolygon);
-		r.tris.emplace(pr, trisInFace);
+		auto& tris{ r[pr] };
+		tris.reserve(tris.size() + it->second.size());
+		for (const auto& t : it->second) {
+			tris.push_back(sd.triangles.getTriangle(t));
+		}
 	}
 }
 
-void Slice::fillLines(FaceFilling& r, const ArrayIndex& idx) const 
+void Slice::collectLines(PrPolylines& r, const ArrayIndex& idx) const
 {
-	auto cellFace{ buildCellFace(idx) };
 	for (const auto& [pr, sd] : data_) {
 		for (const auto& lineMap : sd.lineMaps) {
 			auto it{ lineMap.find(idx) };
 			if (it == lineMap.end()) {
 				continue;
 			}
-			const auto& plRange{ it->second };
-			for (const auto& it : plRange) {
-				Polyline2 polylineChunk{ *it, *std::next(it) };
-				auto p{ buildCellLineIntersection(cellFace, polylineChunk) };
-				if (!p.empty()) {
-					r.lins[pr].push_back(p);
-				}
+			for (const auto& vIt : it->second) {
+				r[pr].push_back({ *vIt, *std::next(vIt) });
 			}
 		}
 	}
@@ -514,58 +347,219 @@ void Slice::fillLines(FaceFilling& r, const ArrayIndex& idx) const
 
 FillingState Slice::getFillingState(const ArrayIndex& idx) const
 {
-	if (nonEdgeAlignedContourIndices_.count(idx) != 0) {
-		return FillingState{ FillingType::Partial };
-	}	
+	return fillingRaster_.getFillingState(idx);
+}
+
+void Slice::getFillingStates(std::vector<FillingState>& res, const ArrayIndex& size) const
+{
+	fillingRaster_.fill(res, size);
+}
+
+std::vector<std::vector<ArrayIndex>> Slice::getPartialFacesRows() const
+{
+	return fillingRaster_.getRows(FillingType::Partial);
+}
+
+Fractions Slice::getAreaFractions(const ArrayIndex& idx) const
+{
+	const auto state{ getFillingState(idx) };
+	if (state.full()) {
+		return { { state.getPriority(), 1.0 } };
+	}
+	auto it{ partialAreaFractions_.find(idx) };
+	if (it == partialAreaFractions_.end()) {
+		return Fractions();
+	}
+	return it->second;
+}
+
+void Slice::getAreaFractions(
+	std::vector<double>& res, 
+	const ArrayIndex& size, 
+	const Priority& pr) const
+{
+	std::vector<FillingState> states;
+	fillingRaster_.fill(states, size);
+	res.assign(states.size(), 0.0);
+	for (std::size_t f{ 0 }; f < states.size(); ++f) {
+		const auto& state{ states[f] };
+		if (state.full() && state.getPriority() == pr) {
+			res[f] = 1.0;
+		}
+		else if (state.partial()) {
+			const ArrayIndex idx{ CellDir(f / size[1]), CellDir(f % size[1]) };
+			auto it{ partialAreaFractions_.find(idx) };
+			if (it == partialAreaFractions_.end()) {
+				continue;
+			}
+			auto frac{ it->second.find(pr) };
+			if (frac != it->second.end()) {
+				res[f] = frac->second;
+			}
+		}
+	}
+}
+
+void Slice::write(fillerFile::Writer& w, const Axis& x) const
+{
+	// Lines running along grid lines cross faces which are not partial,
+	// so every face with triangles or segments gets a record.
+	std::set<ArrayIndex> indices;
+	for (const auto& row : fillingRaster_.getRows(FillingType::Partial)) {
+		indices.insert(row.begin(), row.end());
+	}
 	for (const auto& [pr, sd] : data_) {
-		if (sd.trianglesMaps.count(idx) != 0) {
-			return FillingState{ pr };
+		for (const auto& [idx, tris] : sd.trianglesMaps) {
+			indices.insert(idx);
+		}
+		for (const auto& lineMap : sd.lineMaps) {
+			for (const auto& [idx, its] : lineMap) {
+				indices.insert(idx);
+			}
+		}
+	}
+
+	std::vector<fillerFile::Writer::Face> faces;
+	faces.reserve(indices.size());
+	for (const auto& idx : indices) {
+		fillerFile::Writer::Face face{ idx };
+		for (const auto& [pr, sd] : data_) {
+			auto it{ sd.trianglesMaps.find(idx) };
+			if (it != sd.trianglesMaps.end()) {
+				for (const auto& tId : it->second) {
+					fillerFile::TriangleRecord t{};
+					for (int i{ 0 }; i < 3; ++i) {
+						const auto& v{ sd.triangles.vertices[sd.triangles.triangles[tId][i]] };
+						t.coordinates[2 * i] = v[0];
+						t.coordinates[2 * i + 1] = v[1];
+					}
+					t.priority = pr;
+					face.triangles.push_back(t);
+				}
+			}
+			for (const auto& lineMap : sd.lineMaps) {
+				auto lIt{ lineMap.find(idx) };
+				if (lIt == lineMap.end()) {
+					continue;
+				}
+				for (const auto& vIt : lIt->second) {
+					fillerFile::SegmentRecord seg{};
+					seg.coordinates = { vIt->x(), vIt->y(), std::next(vIt)->x(), std::next(vIt)->y() };
+					seg.priority = pr;
+					face.segments.push_back(seg);
+				}
+			}
+		}
+		auto fIt{ partialAreaFractions_.find(idx) };
+		if (fIt != partialAreaFractions_.end()) {
+			for (const auto& [pr, fraction] : fIt->second) {
+				face.fractions.push_back({ pr, 0, fraction });
+			}
 		}
+		faces.push_back(std::move(face));
 	}
-	return FillingState{ FillingType::Empty };
+	w.addSlice(x, fillingRaster_, faces);
 }
 
 FaceFilling Slice::getFaceFilling(const ArrayIndex& idx) const
 {
-	FaceFilling res;
-	fillSurfaces(res, idx);
-	fillLines(res, idx);
-	return res;
+	const auto state{ getFillingState(idx) };
+	PrTriangles tris;
+	if (!state.full()) {
+		collectTriangles(tris, idx);
+	}
+	PrPolylines lins;
+	collectLines(lins, idx);
+	return buildFaceFilling(state, idx, tris, lins);
 }
 
-TriVs Slice::buildAllTriVs(const Priority& pr, Axis x, Height h) const
+std::vector<FaceFilling> Slice::getFaceFillings(const std::vector<ArrayIndex>& row) const
 {
-	TriVs res;
-	auto it = data_.find(pr);
-	if (it == data_.end()) {
-		return res;
-	}
-	
-	for (const auto& triangulation : it->second.triangulations) {
-		for (const auto& f : triangulation.finite_face_handles()) {
-			if (f->info().in_domain()) {
-				res.push_back(buildTriVFromFace(*f, x, h));
+	// Neighbouring faces share most of their triangles, so the triangles of
+	// each priority in the row are joined once and intersected with each
+	// face. Triangles not crossing a face do not overlap it.
+	std::map<Priority, HPolygonSet> rowSurfaces;
+	std::vector<TriangleSoup::Index> ids;
+	std::vector<Triangle2> tris;
+	for (const auto& [pr, sd] : data_) {
+		ids.clear();
+		for (const auto& idx : row) {
+			auto it{ sd.trianglesMaps.find(idx) };
+			if (it != sd.trianglesMaps.end()) {
+				ids.insert(ids.end(), it->second.begin(), it->second.end());
 			}
 		}
+		if (ids.empty()) {
+			continue;
+		}
+		std::sort(ids.begin(), ids.end());
+		ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+		tris.clear();
+		for (const auto& t : ids) {
+			tris.push_back(sd.triangles.getTriangle(t));
+		}
+		rowSurfaces.emplace(pr, buildPolygonSetFromTriangles(tris));
+	}
+
+	std::vector<FaceFilling> res;
+	res.reserve(row.size());
+	PrPolylines lins;
+	for (const auto& idx : row) {
+		const auto state{ getFillingState(idx) };
+		lins.clear();
+		collectLines(lins, idx);
+		auto ff{ buildFaceFilling(state, idx, {}, lins) };
+		if (!state.full()) {
+			const auto cellFacePolygon{ buildCellFacePolygon(idx) };
+			for (const auto& [pr, surfaces] : rowSurfaces) {
+				if (data_.at(pr).trianglesMaps.count(idx) == 0) {
+					continue;
+				}
+				auto trisInFace{ surfaces };
+				trisInFace.intersection(cellFacePolygon);
+				ff.tris.emplace(pr, std::move(trisInFace));
+			}
+		}
+		res.push_back(std::move(ff));
 	}
 	return res;
 }
 
-LinVs Slice::buildAllLinVs(const Priority& pr, Axis x, Height h) const
+Slice::IndexedFilling Slice::buildIndexedFilling(const Axis& x, const Height& h) const
 {
-	LinVs res;
-	auto it = data_.find(pr);
-	if (it == data_.end()) {
-		return res;
-	}
-
-	for (const auto& pl : it->second.lines) {
-		for (auto vIt{ pl.begin() }; std::next(vIt) != pl.end(); ++vIt) {
-			LinV lin{
-				buildCoordinateFromPoint2(*vIt, h, x),
-				buildCoordinateFromPoint2(*std::next(vIt), h, x)
-			};
-			res.push_back(lin);
+	IndexedFilling res;
+	std::map<std::array<double, 2>, CoordinateId> ids;
+	auto addVertex = [&](const std::array<double, 2>& v) {
+		auto it{ ids.emplace(v, res.coordinates.size()) };
+		if (it.second) {
+			res.coordinates.push_back(buildCoordinateFromPoint2(Point2(v[0], v[1]), h, x));
+		}
+		return it.first->second;
+	};
+
+	for (const auto& [pr, sd] : data_) {
+		auto& es{ res.elements[pr] };
+		const auto& soup{ sd.triangles };
+		std::vector<CoordinateId> soupIds;
+		soupIds.reserve(soup.vertices.size());
+		for (const auto& v : soup.vertices) {
+			soupIds.push_back(addVertex(v));
+		}
+		es.reserve(soup.size());
+		for (const auto& t : soup.triangles) {
+			es.emplace_back(
+				std::vector<CoordinateId>{ soupIds[t[0]], soupIds[t[1]], soupIds[t[2]] },
+				Element::Type::Surface);
+		}
+		for (const auto& pl : sd.lines) {
+			for (auto vIt{ pl.begin() }; std::next(vIt) != pl.end(); ++vIt) {
+				es.emplace_back(
+					std::vector<CoordinateId>{
+						addVertex({ vIt->x(), vIt->y() }),
+						addVertex({ std::next(vIt)->x(), std::next(vIt)->y() })
+					},
+					Element::Type::Line);
+			}
 		}
 	}
 	return res;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "FillerTools.h"
+#include "FillingRaster.h"
 #include "cgal/HPolygonSet.h"
 
 #include <boost/unordered_set.hpp>
@@ -12,110 +13,73 @@ namespace filler {
 
 using namespace cgal;
 
-enum class FillingType {
-	Empty,
-	Partial,
-	Full
-};
-
-class FillingState {
-public:
-	FillingType type;
-
-	FillingState(const FillingType& t);
-	FillingState(const Priority& p);
-	Priority getPriority() const;
-
-	bool empty() const { return type == FillingType::Empty; }
-	bool partial() const { return type == FillingType::Partial; }
-	bool full() const { return type == FillingType::Full; }
-private:
-	Priority priority_;
-};
-
-
-struct FaceFilling {
-	std::map<Priority, Polylines2> lins;
-	std::map<Priority, HPolygonSet> tris;
-
-	bool operator==(const FaceFilling& rhs) const {
-		return lins == rhs.lins 
-			&& tris == rhs.tris;
-	}
-
-	HPolygonSet allSurfaces() const { 
-		HPolygonSet res;
-		for (const auto& t: tris) {
-			res.join(t.second);
-		}
-		return res;
-	}
-	HPolygonSet metalSurfaces() const { 
-		HPolygonSet res;
-		for (const auto& [pr, pols] : tris) {
-			if (pr > 0) {
-				res.join(pols);
-			}
-		}
-		return res;
-	}
-	HPolygonSet dielectricSurfaces() const { 
-		HPolygonSet res;
-		for (const auto& [pr, pols] : tris) {
-			if (pr < 0) {
-				res.join(pols);
-			}
-		}
-		return res;
-	}
-};
+namespace fillerFile {
+class Writer;
+}
 
 class Slice {
 public:
 	using ContourIndexSet = boost::unordered_set<ArrayIndex>;
-	using SurfaceMap = boost::unordered_map<ArrayIndex, std::vector<const CDT::Face*>>;
+	using SurfaceMap = boost::unordered_map<ArrayIndex, std::vector<TriangleSoup::Index>>;
 	using LineMap = boost::unordered_map<ArrayIndex, std::vector<Polyline2::const_iterator>>;
 	using LineMaps = std::vector<LineMap>;
 
+	// Elements of each priority index coordinates shared by the whole slice.
+	struct IndexedFilling {
+		Coordinates coordinates;
+		std::map<Priority, Elements> elements;
+	};
+
 	Slice() = default;
 	Slice& operator=(const Slice&) = delete;
 
 	FaceFilling getFaceFilling(const ArrayIndex&) const;
-	LinVs buildAllLinVs(const Priority&, Axis, Height) const;
-	TriVs buildAllTriVs(const Priority&, Axis, Height) const;
+	// Same fillings as getFaceFilling for faces of a row, in the given order.
+	std::vector<FaceFilling> getFaceFillings(const std::vector<ArrayIndex>& row) const;
+	IndexedFilling buildIndexedFilling(const Axis&, const Height&) const;
 	FillingState getFillingState(const ArrayIndex&) const;
+	void getFillingStates(std::vector<FillingState>&, const ArrayIndex& size) const;
+	std::vector<std::vector<ArrayIndex>> getPartialFacesRows() const;
+	Fractions getAreaFractions(const ArrayIndex&) const;
+	void getAreaFractions(std::vector<double>&, const ArrayIndex& size, const Priority&) const;
 
 	void add(const Polylines2&, const Priority&);
 	void addAsPolygon(const Polylines2&, const Priority&);
 	void add(const HPolygonSet&, const Priority&);
 	void mergeLines(const Slice& lhs);
+	// Surfaces of higher priorities are removed from lower ones.
+	void resolvePriorities();
 	void buildSearchMap();
 	void buildTriangulations();
 	void simplifySurfaces();
 	void cleanSurfaces();
+	void write(fillerFile::Writer&, const Axis&) const;
 private:
 	struct SliceData {
 		Polylines2 lines;
 		HPolygonSet surfaces;
 		
-		CDTs triangulations;
+		TriangleSoup triangles;
+		// Indices of the triangles crossing partial faces, faces fully
+		// covered are stored as spans in the filling raster.
 		SurfaceMap trianglesMaps;
 		LineMaps lineMaps;
 
 		SliceData() = default;
 		SliceData& operator=(const SliceData&) = delete;
-		void buildSurfaceMaps();
+		void buildSurfaceMaps(const ContourIndexSet&, const Priority&, FillingRaster::Spans&);
 		void buildLineMaps();
-		void buildMaps();
 		bool isEmpty() const;
 	};
 
 	std::map<Priority, SliceData> data_;
 	ContourIndexSet nonEdgeAlignedContourIndices_;
+	FillingRaster fillingRaster_;
+	boost::unordered_map<ArrayIndex, Fractions> partialAreaFractions_;
 		
-	void fillSurfaces(FaceFilling&, const ArrayIndex&) const;
-	void fillLines(FaceFilling&, const ArrayIndex&) const;
-	void removeInSuperiorPriorities(const Priority& pr);
+	void collectTriangles(PrTriangles&, const ArrayIndex&) const;
+	void collectLines(PrPolylines&, const ArrayIndex&) const;
+	void buildAreaFractions();
 };
 
 }
@@ -0,0 +1,204 @@
+#include "SweepSlicer.h"
+
+#ifdef TESSELLATOR_EXECUTION_POLICIES
+#include <execution>
+#endif
+
+#include <cmath>
+#include <numeric>
+#include <set>
+
+namespace meshlib {
+namespace tessellator {
+namespace filler {
+
+int getSide(const Coordinate& c, const Axis& x, const SliceNumber& h)
+{
+	if (c[x] < h) {
+		return -1;
+	}
+	if (c[x] > h) {
+		return 1;
+	}
+	return 0;
+}
+
+SweepSlicer::SweepSlicer(const Mesh& mesh) :
+	mesh_{ mesh }
+{
+	for (const auto& x : { X, Y, Z }) {
+		const SliceNumber numberOfPlanes{ (SliceNumber)mesh_.grid[x].size() };
+		std::vector<std::vector<const Element*>> buckets(numberOfPlanes);
+		for (const auto& g : mesh_.groups) {
+			for (const auto& e : g.elements) {
+				if (!e.isTriangle()) {
+					continue;
+				}
+				auto [minIt, maxIt] = std::minmax_element(
+					e.vertices.begin(), e.vertices.end(),
+					[&](const auto& lhs, const auto& rhs) {
+						return mesh_.coordinates[lhs][x] < mesh_.coordinates[rhs][x];
+					}
+				);
+				const SliceNumber lo{ std::max((SliceNumber)std::ceil(mesh_.coordinates[*minIt][x]), 0) };
+				const SliceNumber hi{ std::min((SliceNumber)std::floor(mesh_.coordinates[*maxIt][x]), numberOfPlanes - 1) };
+				for (SliceNumber h{ lo }; h <= hi; ++h) {
+					buckets[h].push_back(&e);
+				}
+			}
+		}
+
+		std::vector<Polylines> planePolylines(numberOfPlanes);
+		std::vector<SliceNumber> planes(numberOfPlanes);
+		std::iota(planes.begin(), planes.end(), 0);
+		std::for_each(
+#ifdef TESSELLATOR_EXECUTION_POLICIES
+			std::execution::par,
+#endif
+			planes.begin(), planes.end(),
+			[&](const auto& h) {
+				if (!buckets[h].empty()) {
+					planePolylines[h] = chainSegments(sliceTriangles(buckets[h], x, h));
+				}
+			}
+		);
+
+		for (SliceNumber h{ 0 }; h < numberOfPlanes; ++h) {
+			if (!planePolylines[h].empty()) {
+				polylines_[x][h] = std::move(planePolylines[h]);
+			}
+		}
+	}
+}
+
+Coordinate SweepSlicer::buildNodePoint(const Node& n, const Axis& x, const SliceNumber& h) const
+{
+	const Coordinate& a{ mesh_.coordinates[n.first] };
+	if (n.first == n.second) {
+		return a;
+	}
+	// Edges are always interpolated from their lower id, so both triangles
+	// sharing an edge get exactly the same point.
+	const Coordinate& b{ mesh_.coordinates[n.second] };
+	Coordinate res{ a + (b - a) * ((h - a[x]) / (b[x] - a[x])) };
+	res[x] = h;
+	return res;
+}
+
+SweepSlicer::Segments SweepSlicer::sliceTriangles(
+	const std::vector<const Element*>& tris,
+	const Axis& x,
+	const SliceNumber& h) const
+{
+	Coordinate planeNormal;
+	planeNormal[x] = 1.0;
+
+	Segments res;
+	std::set<std::pair<Node, Node>> edgesOnPlane;
+	for (const auto& tri : tris) {
+		const auto& vs{ tri->vertices };
+		std::array<int, 3> sides;
+		for (std::size_t i{ 0 }; i < 3; ++i) {
+			sides[i] = getSide(mesh_.coordinates[vs[i]], x, h);
+		}
+		if (sides[0] == 0 && sides[1] == 0 && sides[2] == 0) {
+			continue;
+		}
+
+		std::vector<Node> nodes;
+		for (std::size_t i{ 0 }; i < 3; ++i) {
+			const std::size_t j{ (i + 1) % 3 };
+			if (sides[i] == 0) {
+				nodes.push_back({ vs[i], vs[i] });
+			}
+			else if (sides[i] * sides[j] < 0) {
+				nodes.push_back(std::minmax(vs[i], vs[j]));
+			}
+		}
+		if (nodes.size() != 2) {
+			continue;
+		}
+
+		bool isEdgeOnPlane{ nodes[0].first == nodes[0].second && nodes[1].first == nodes[1].second };
+		if (isEdgeOnPlane && !edgesOnPlane.insert(std::minmax(nodes[0], nodes[1])).second) {
+			continue;
+		}
+
+		Segment s{
+			{ nodes[0], nodes[1] },
+			{ buildNodePoint(nodes[0], x, h), buildNodePoint(nodes[1], x, h) }
+		};
+
+		// Segments run along planeNormal x faceNormal, so that closed
+		// outwards oriented surfaces produce counter-clockwise contours.
+		const auto& c{ mesh_.coordinates };
+		const Coordinate faceNormal{ (c[vs[1]] - c[vs[0]]) ^ (c[vs[2]] - c[vs[0]]) };
+		if ((s.points[1] - s.points[0]) * (planeNormal ^ faceNormal) < 0.0) {
+			std::swap(s.nodes[0], s.nodes[1]);
+			std::swap(s.points[0], s.points[1]);
+		}
+		res.push_back(s);
+	}
+	return res;
+}
+
+SweepSlicer::Polylines SweepSlicer::chainSegments(const Segments& segs)
+{
+	std::map<Node, std::vector<std::size_t>> incident;
+	for (std::size_t s{ 0 }; s < segs.size(); ++s) {
+		for (const auto& n : segs[s].nodes) {
+			incident[n].push_back(s);
+		}
+	}
+
+	Polylines res;
+	std::vector<bool> used(segs.size(), false);
+	auto walk = [&](Node n, std::size_t s) {
+		const std::size_t first{ segs[s].nodes[0] == n ? 0u : 1u };
+		Coordinates pl{ segs[s].points[first] };
+		int orientation{ 0 };
+		while (true) {
+			used[s] = true;
+			const std::size_t from{ segs[s].nodes[0] == n ? 0u : 1u };
+			orientation += from == 0 ? 1 : -1;
+			pl.push_back(segs[s].points[1 - from]);
+			n = segs[s].nodes[1 - from];
+
+			const auto& next{ incident.at(n) };
+			if (next.size() != 2) {
+				break;
+			}
+			s = used[next[0]] ? next[1] : next[0];
+			if (used[s]) {
+				break;
+			}
+		}
+		if (orientation < 0) {
+			std::reverse(pl.begin(), pl.end());
+		}
+		res.push_back(std::move(pl));
+	};
+
+	// Open polylines start and end in nodes not shared by two segments.
+	for (const auto& [n, ss] : incident) {
+		if (ss.size() == 2) {
+			continue;
+		}
+		for (const auto& s : ss) {
+			if (!used[s]) {
+				walk(n, s);
+			}
+		}
+	}
+	// Remaining segments form closed polylines.
+	for (std::size_t s{ 0 }; s < segs.size(); ++s) {
+		if (!used[s]) {
+			walk(segs[s].nodes[0], s);
+		}
+	}
+	return res;
+}
+
+}
+}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "types/Mesh.h"
+#include "types/CellIndex.h"
+
+#include <map>
+
+namespace meshlib {
+namespace tessellator {
+namespace filler {
+
+// Cuts the triangles of a mesh by all the grid planes in a single sweep.
+// Triangles are bucketed by the integer planes their extent covers, so
+// every plane only visits the triangles crossing it. Segments are chained
+// through the mesh vertices and edges they pass through, which makes the
+// resulting polylines independent of floating point comparisons.
+// Coordinates are expected to be relative to the grid.
+class SweepSlicer {
+public:
+	using Polylines = std::vector<Coordinates>;
+	using PlanesPolylines = std::map<SliceNumber, Polylines>;
+	using GridPolylines = std::array<PlanesPolylines, 3>;
+
+	SweepSlicer(const Mesh&);
+	const GridPolylines& getPolylines() const { return polylines_; }
+
+private:
+	// A vertex is stored as a pair of equal ids, an edge as sorted ids.
+	using Node = std::pair<CoordinateId, CoordinateId>;
+	struct Segment {
+		std::array<Node, 2> nodes;
+		std::array<Coordinate, 2> points;
+	};
+	using Segments = std::vector<Segment>;
+
+	const Mesh& mesh_;
+	GridPolylines polylines_;
+
+	Segments sliceTriangles(const std::vector<const Element*>&, const Axis&, const SliceNumber&) const;
+	Coordinate buildNodePoint(const Node&, const Axis&, const SliceNumber&) const;
+
+	static Polylines chainSegments(const Segments&);
+};
+
+}
+}
+}
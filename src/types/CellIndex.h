@@ -3,6 +3,7 @@
 #include "utils/Types.h"
 
 #include <boost/array.hpp>
+#include <boost/functional/hash.hpp>
 
 namespace meshlib {
 
@@ -28,6 +29,19 @@ struct CellIndex {
 	SliceNumber getSliceNumber() const {
 		return ijk[axis];
 	}
+	bool operator==(const CellIndex& rhs) const {
+		return ijk == rhs.ijk && axis == rhs.axis;
+	}
+};
+
+struct CellIndexHash {
+	std::size_t operator()(const CellIndex& c) const {
+		std::size_t res{ c.axis };
+		for (std::size_t d{ 0 }; d < 3; ++d) {
+			boost::hash_combine(res, c.ijk[d]);
+		}
+		return res;
+	}
 };
 
-}
\ No newline at end of file
+}
@@ -9,6 +9,7 @@
 #include <set>
 #include <algorithm>
 #include <unordered_set> 
+#include <unordered_map>
 
 namespace meshlib {
 namespace utils {
@@ -141,8 +142,7 @@ void Cleaner::collapseCoordsInLineDegenerateTriangles(Mesh& m, const double& are
             }
         }
 
-        fuseCoords(m);
-        cleanCoords(m);
+        Pipeline().fuseCoords().cleanCoords().apply(m);
     }
      
     std::stringstream msg;
@@ -167,12 +167,145 @@ void Cleaner::collapseCoordsInLineDegenerateTriangles(Mesh& m, const double& are
 
 void Cleaner::fuseCoords(Mesh& mesh) 
 {
-    fuseCoords_(mesh);
-    removeElementsWithCondition(mesh, [&](const Element& e) {
-        return IdSet(e.vertices.begin(), e.vertices.end()).size() != e.vertices.size();
-    });
+    Pipeline().fuseCoords().apply(mesh);
 }
 
+void Cleaner::fuseLatticeCoords(Mesh& mesh, const Lattice& lattice)
+{
+    // Coordinates are moved to the lattice, so fused ones are found by an
+    // exact integer hash instead of comparing their positions.
+    Pipeline().fuseLatticeCoords(lattice).apply(mesh);
+}
+
+Cleaner::Pipeline& Cleaner::Pipeline::removeElementsWithCondition(
+    std::function<bool(const Element&)> cnd)
+{
+    conditions_.push_back(cnd);
+    return *this;
+}
+
+Cleaner::Pipeline& Cleaner::Pipeline::fuseCoords()
+{
+    fuse_ = true;
+    return *this;
+}
+
+Cleaner::Pipeline& Cleaner::Pipeline::fuseLatticeCoords(const Lattice& lattice)
+{
+    fuse_ = true;
+    lattice_ = lattice;
+    return *this;
+}
+
+Cleaner::Pipeline& Cleaner::Pipeline::removeRepeatedElements()
+{
+    removeRepeated_ = true;
+    return *this;
+}
+
+Cleaner::Pipeline& Cleaner::Pipeline::cleanCoords()
+{
+    clean_ = true;
+    return *this;
+}
+
+void Cleaner::Pipeline::apply(Mesh& m)
+{
+    Coordinates& cs = m.coordinates;
+
+    // Filters input elements and marks the coordinates they use.
+    used_.assign(cs.size(), false);
+    for (auto& g : m.groups) {
+        auto& elems = g.elements;
+        if (!conditions_.empty()) {
+            elems.erase(
+                std::remove_if(elems.begin(), elems.end(), [&](const Element& e) {
+                    return std::any_of(conditions_.begin(), conditions_.end(),
+                        [&](const auto& cnd) { return cnd(e); });
+                }),
+                elems.end()
+            );
+        }
+        for (const auto& e : elems) {
+            for (const auto& id : e.vertices) {
+                used_[id] = true;
+            }
+        }
+    }
+
+    // Used coordinates at the same position are replaced by the lowest id.
+    newIds_.resize(cs.size());
+    for (CoordinateId id = 0; id < cs.size(); id++) {
+        newIds_[id] = id;
+    }
+    if (fuse_ && lattice_) {
+        std::unordered_map<Lattice::Point, CoordinateId, Lattice::PointHash> pointToId;
+        for (CoordinateId id = 0; id < cs.size(); id++) {
+            const auto p{ lattice_->toPoint(cs[id]) };
+            cs[id] = lattice_->toRelative(p);
+            if (used_[id]) {
+                newIds_[id] = pointToId.emplace(p, id).first->second;
+            }
+        }
+    }
+    else if (fuse_) {
+        CoordinateMap posToId;
+        for (CoordinateId id = 0; id < cs.size(); id++) {
+            if (used_[id]) {
+                newIds_[id] = posToId.emplace(cs[id], id).first->second;
+            }
+        }
+    }
+
+    // Remaps vertices, drops collapsed and repeated elements and marks 
+    // the coordinates which remain in use.
+    used_.assign(cs.size(), false);
+    std::set<CoordinateIds> rotatedVertices;
+    for (auto& g : m.groups) {
+        auto& elems = g.elements;
+        rotatedVertices.clear();
+        auto last = std::remove_if(elems.begin(), elems.end(), [&](Element& e) {
+            for (auto& id : e.vertices) {
+                id = newIds_[id];
+            }
+            if (fuse_ && 
+                IdSet(e.vertices.begin(), e.vertices.end()).size() != e.vertices.size()) {
+                return true;
+            }
+            if (removeRepeated_) {
+                CoordinateIds vIds{ e.vertices };
+                std::rotate(vIds.begin(), std::min_element(vIds.begin(), vIds.end()), vIds.end());
+                if (!rotatedVertices.insert(vIds).second) {
+                    return true;
+                }
+            }
+            for (const auto& id : e.vertices) {
+                used_[id] = true;
+            }
+            return false;
+        });
+        elems.erase(last, elems.end());
+    }
+
+    if (!clean_) {
+        return;
+    }
+    CoordinateId numberOfUsed = 0;
+    for (CoordinateId id = 0; id < cs.size(); id++) {
+        if (used_[id]) {
+            newIds_[id] = numberOfUsed;
+            cs[numberOfUsed++] = cs[id];
+        }
+    }
+    cs.resize(numberOfUsed);
+    for (auto& g : m.groups) {
+        for (auto& e : g.elements) {
+            for (auto& id : e.vertices) {
+                id = newIds_[id];
+            }
+        }
+    }
+}
 
 void Cleaner::cleanElems_(Mesh& output, Map& map) 
 {
@@ -259,32 +392,6 @@ void Cleaner::cleanCoords_(Mesh& output, Map& map)
     
 }
 
-void Cleaner::fuseCoords_(Mesh& msh) 
-{
-    std::map<Coordinate, IdSet> posIds;
-    for (GroupId g = 0; g < msh.groups.size(); g++) {
-        for (ElementId e = 0; e < msh.groups[g].elements.size(); e++) {
-            const Element& elem = msh.groups[g].elements[e];
-            for (std::size_t i = 0; i < elem.vertices.size(); i++) {
-                CoordinateId id = elem.vertices[i];
-                Coordinate pos = msh.coordinates[id];
-                posIds[pos].insert(id);
-            }
-        }
-    }
-
-    for (GroupId g = 0; g < msh.groups.size(); g++) {
-        for (ElementId e = 0; e < msh.groups[g].elements.size(); e++) {
-            Element& elem = msh.groups[g].elements[e];
-            for (std::size_t i = 0; i < elem.vertices.size(); i++) {
-                CoordinateId oldMeshedId = elem.vertices[i];
-                CoordinateId newMeshedId = *posIds[msh.coordinates[oldMeshedId]].begin();
-                std::replace(elem.vertices.begin(), elem.vertices.end(), oldMeshedId, newMeshedId);
-            }
-        }
-    }
-}
-
 void Cleaner::removeElements(Mesh& mesh, const std::vector<IdSet>& toRemove) 
 {
     for (GroupId gId = 0; gId < mesh.groups.size(); gId++) {
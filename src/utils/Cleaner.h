@@ -2,17 +2,45 @@
 
 #include "../types/Map.h"
 #include "../types/Mesh.h"
+#include "Lattice.h"
 
 #include <functional>
+#include <optional>
 
 namespace meshlib {
 namespace utils {
 
 class Cleaner {
 public:
+    // Runs several cleaning operations sharing traversals of the mesh.
+    // Regardless of the order in which they are added, operations are applied
+    // as: element conditions, coordinates fusion, removal of repeated
+    // elements and removal of unused coordinates.
+    class Pipeline {
+    public:
+        Pipeline& removeElementsWithCondition(std::function<bool(const Element&)>);
+        Pipeline& fuseCoords();
+        Pipeline& fuseLatticeCoords(const Lattice&);
+        Pipeline& removeRepeatedElements();
+        Pipeline& cleanCoords();
+
+        void apply(Mesh&);
+
+    private:
+        std::vector<std::function<bool(const Element&)>> conditions_;
+        bool fuse_{ false };
+        std::optional<Lattice> lattice_;
+        bool removeRepeated_{ false };
+        bool clean_{ false };
+
+        std::vector<bool> used_;
+        std::vector<CoordinateId> newIds_;
+    };
+
     static void clean(Mesh&, Map&);
     static void cleanCoords(Mesh&);
     static void fuseCoords(Mesh&);
+    static void fuseLatticeCoords(Mesh&, const Lattice&);
     static void removeElementsWithCondition(Mesh&, std::function<bool(const Element&)>);
     static void collapseCoordsInLineDegenerateTriangles(Mesh&, const double& areaThreshold);
     static void removeRepeatedElements(Mesh&);
@@ -21,7 +49,6 @@ public:
 private:
     static void cleanElems_(Mesh&, Map&);
     static void cleanCoords_(Mesh&, Map&);
-    static void fuseCoords_(Mesh&);
 
     static Elements findDegenerateElements_(const Group&, const Coordinates&);
   };
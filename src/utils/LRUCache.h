@@ -0,0 +1,96 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace meshlib {
+namespace utils {
+
+// Thread safe least recently used cache bounded by an estimated memory
+// budget. Values larger than the whole budget are never stored.
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class LRUCache {
+public:
+    using SizeEstimator = std::function<std::size_t(const Value&)>;
+
+    struct Stats {
+        std::size_t hits{ 0 };
+        std::size_t misses{ 0 };
+    };
+
+    LRUCache(std::size_t memoryBudget, SizeEstimator estimator) :
+        memoryBudget_{ memoryBudget },
+        estimator_{ estimator }
+    {}
+
+    std::optional<Value> find(const Key& key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it{ index_.find(key) };
+        if (it == index_.end()) {
+            stats_.misses++;
+            return std::nullopt;
+        }
+        stats_.hits++;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return it->second->value;
+    }
+
+    void insert(const Key& key, const Value& value)
+    {
+        const std::size_t size{ estimator_(value) };
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (size > memoryBudget_ || index_.count(key) != 0) {
+            return;
+        }
+        while (memoryUsage_ + size > memoryBudget_) {
+            const auto& last{ entries_.back() };
+            memoryUsage_ -= last.size;
+            index_.erase(last.key);
+            entries_.pop_back();
+        }
+        entries_.push_front({ key, value, size });
+        index_.emplace(key, entries_.begin());
+        memoryUsage_ += size;
+    }
+
+    Stats getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    std::size_t getMemoryUsage() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return memoryUsage_;
+    }
+
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+private:
+    struct Entry {
+        Key key;
+        Value value;
+        std::size_t size;
+    };
+
+    std::size_t memoryBudget_;
+    SizeEstimator estimator_;
+    std::size_t memoryUsage_{ 0 };
+    Stats stats_;
+
+    std::list<Entry> entries_;
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index_;
+    mutable std::mutex mutex_;
+};
+
+}
+}
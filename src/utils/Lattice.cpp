@@ -0,0 +1,80 @@
+#include "Lattice.h"
+
+#include <boost/functional/hash.hpp>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace meshlib {
+namespace utils {
+
+bool Lattice::Point::operator==(const Point& rhs) const
+{
+    return cell == rhs.cell && fraction == rhs.fraction;
+}
+
+bool Lattice::Point::operator<(const Point& rhs) const
+{
+    for (Axis d = 0; d < 3; d++) {
+        if (cell[d] != rhs.cell[d]) {
+            return cell[d] < rhs.cell[d];
+        }
+        if (fraction[d] != rhs.fraction[d]) {
+            return fraction[d] < rhs.fraction[d];
+        }
+    }
+    return false;
+}
+
+std::size_t Lattice::PointHash::operator()(const Point& p) const
+{
+    std::size_t res = 0;
+    for (Axis d = 0; d < 3; d++) {
+        boost::hash_combine(res, p.cell[d]);
+        boost::hash_combine(res, p.fraction[d]);
+    }
+    return res;
+}
+
+Lattice::Lattice(int decimalPlaces)
+{
+    if (decimalPlaces < 0 || decimalPlaces > 9) {
+        throw std::logic_error("Lattice fraction does not fit requested decimal places");
+    }
+    scale_ = 1;
+    for (int i = 0; i < decimalPlaces; i++) {
+        scale_ *= 10;
+    }
+}
+
+Lattice::Point Lattice::toPoint(const Relative& rel) const
+{
+    Point res;
+    for (Axis d = 0; d < 3; d++) {
+        const std::int64_t n{ std::llround(rel[d] * scale_) };
+        std::int64_t cell{ n / scale_ };
+        std::int64_t fraction{ n % scale_ };
+        if (fraction < 0) {
+            cell--;
+            fraction += scale_;
+        }
+        res.cell[d] = (CellDir) cell;
+        res.fraction[d] = (Fraction) fraction;
+    }
+    return res;
+}
+
+Relative Lattice::toRelative(const Point& p) const
+{
+    // Same rounding as Vector::round with a factor equal to the scale.
+    Relative res;
+    for (Axis d = 0; d < 3; d++) {
+        const std::int64_t n{ std::int64_t(p.cell[d]) * scale_ + p.fraction[d] };
+        res[d] = double(n) / double(scale_);
+    }
+    return res;
+}
+
+}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Types.h"
+
+#include <cstdint>
+
+namespace meshlib {
+namespace utils {
+
+// Relative coordinates stored as a cell and a fixed-point fraction inside it,
+// so that equality, ordering and hashing are exact.
+class Lattice {
+public:
+    using Fraction = std::int32_t;
+
+    struct Point {
+        Cell cell;
+        std::array<Fraction, 3> fraction;
+
+        bool operator==(const Point& rhs) const;
+        bool operator!=(const Point& rhs) const { return !(*this == rhs); }
+        bool operator<(const Point& rhs) const;
+    };
+
+    struct PointHash {
+        std::size_t operator()(const Point&) const;
+    };
+
+    Lattice(int decimalPlaces);
+
+    Point    toPoint   (const Relative&) const;
+    Relative toRelative(const Point&) const;
+
+private:
+    std::int64_t scale_;
+};
+
+}
+}
@@ -102,7 +102,7 @@ void reduceGrid(Mesh& m, const Grid& nG)
         
     m.grid = nG;
 
-    Cleaner::removeElementsWithCondition(m, [&](const Element&e) {
+    Cleaner::Pipeline().removeElementsWithCondition([&](const Element&e) {
         for (auto& vId : e.vertices) {
             Coordinate& c = m.coordinates[vId];
             for (std::size_t d = 0; d < 3; d++) {
@@ -114,9 +114,8 @@ void reduceGrid(Mesh& m, const Grid& nG)
             }
         }
         return false;
-    });
+    }).cleanCoords().apply(m);
 
-	Cleaner::cleanCoords(m);
     for (auto& c : m.coordinates) {
         c -= offset;
     }
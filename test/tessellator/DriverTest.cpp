@@ -41,6 +41,27 @@ public:
         return opts;
     }
 
+    static void expectSameFillingStates(const Filler& lhs, const Filler& rhs)
+    {
+        for (const auto& x : { X, Y, Z }) {
+            auto lStates{ lhs.getFillingStates(x) };
+            auto rStates{ rhs.getFillingStates(x) };
+            ASSERT_EQ(lStates.size(), rStates.size());
+            for (std::size_t i{ 0 }; i < lStates.size(); ++i) {
+                ASSERT_EQ(lStates[i].size(), rStates[i].size());
+                for (std::size_t j{ 0 }; j < lStates[i].size(); ++j) {
+                    ASSERT_EQ(lStates[i][j].type, rStates[i][j].type);
+                    if (lStates[i][j].full()) {
+                        EXPECT_EQ(lStates[i][j].getPriority(), rStates[i][j].getPriority());
+                    }
+                }
+            }
+        }
+        EXPECT_EQ(
+            lhs.getMeshFilling().countTriangles(),
+            rhs.getMeshFilling().countTriangles());
+    }
+
     static auto getBoundingBoxOfUsedCoordinates(const Mesh& msh) {
         Coordinate min(std::numeric_limits<double>::max());
         Coordinate max(std::numeric_limits<double>::min());
@@ -620,6 +641,26 @@ TEST_F(DriverTest, elementsPartiallyOutOfGrid_dual_bare)
     EXPECT_TRUE(df.getFillingState({ Cell({ 0, 1, 1 }), Z }).full());
 }
 
+TEST_F(DriverTest, fillWithDual_same_as_separate_fillers)
+{
+    auto opts{ buildRawOptions() };
+    opts.volumeGroups = { 0, 1 };
+    Driver h{ buildTwoCubesWithOffsetMesh(1.0), opts };
+
+    auto [f, df] = h.fillWithDual();
+    expectSameFillingStates(h.fill(), f);
+    expectSameFillingStates(h.dualFill(), df);
+}
+
+TEST_F(DriverTest, fillWithDual_elementsPartiallyOutOfGrid)
+{
+    Driver h{ buildTriPartiallyOutOfGridMesh(1.0), buildBareOptions() };
+
+    auto [f, df] = h.fillWithDual();
+    expectSameFillingStates(h.fill(), f);
+    expectSameFillingStates(h.dualFill(), df);
+}
+
 TEST_F(DriverTest, elementsTotallyOutOfGrid)
 {
     Mesh m = buildTriPartiallyOutOfGridMesh(1.0);
@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+
+#include "SnapperTools.h"
+
+using namespace meshlib;
+using namespace tessellator;
+using namespace utils;
+
+class SnapperToolsTest : public ::testing::Test {
+protected:
+	static Grid buildUnitGrid()
+	{
+		return GridTools::buildCartesianGrid(0.0, 3.0, 4);
+	}
+};
+
+TEST_F(SnapperToolsTest, closestSolverPoint_corner)
+{
+	SnapperTools sT(buildUnitGrid());
+
+	auto p{ sT.findClosestSolverPoint(Relative({ 1.2, 0.9, 1.0 })) };
+	EXPECT_EQ(Relative({ 1.0, 1.0, 1.0 }), p.position);
+	EXPECT_EQ(3, p.numberOfEdges);
+}
+
+TEST_F(SnapperToolsTest, closestSolverPoint_edgePoints)
+{
+	SnapperOptions opts;
+	opts.edgePoints = 1;
+	SnapperTools sT(buildUnitGrid(), opts);
+
+	auto p{ sT.findClosestSolverPoint(Relative({ 1.0, 1.4, 2.1 })) };
+	EXPECT_EQ(Relative({ 1.0, 1.5, 2.0 }), p.position);
+	EXPECT_EQ(1, p.numberOfEdges);
+
+	auto q{ sT.findClosestSolverPoint(Relative({ 1.0, 1.2, 2.0 })) };
+	EXPECT_EQ(Relative({ 1.0, 1.0, 2.0 }), q.position);
+	EXPECT_EQ(3, q.numberOfEdges);
+}
+
+TEST_F(SnapperToolsTest, closestSolverPoint_forbiddenLength)
+{
+	SnapperOptions opts;
+	opts.forbiddenLength = 0.25;
+	SnapperTools sT(buildUnitGrid(), opts);
+
+	auto p{ sT.findClosestSolverPoint(Relative({ 0.0, 0.0, 0.4 })) };
+	EXPECT_EQ(Relative({ 0.0, 0.0, 0.25 }), p.position);
+
+	auto q{ sT.findClosestSolverPoint(Relative({ 0.0, 0.0, 0.9 })) };
+	EXPECT_EQ(Relative({ 0.0, 0.0, 1.0 }), q.position);
+}
+
+TEST_F(SnapperToolsTest, edgeIds)
+{
+	SnapperOptions opts;
+	opts.edgePoints = 1;
+	SnapperTools sT(buildUnitGrid(), opts);
+
+	auto p{ sT.findClosestSolverPoint(Relative({ 1.5, 1.0, 1.0 })) };
+	ASSERT_EQ(1, p.numberOfEdges);
+
+	const auto id{ sT.getEdgeId(Cell({ 1, 1, 1 }), p.edges[0]) };
+	EXPECT_EQ(id, sT.getEdgeId(Cell({ 1, 1, 1 }), p.edges[0]));
+	EXPECT_NE(id, sT.getEdgeId(Cell({ 1, 1, 2 }), p.edges[0]));
+	EXPECT_NE(id, sT.getEdgeId(Cell({ 2, 1, 1 }), p.edges[0]));
+
+	auto q{ sT.findClosestSolverPoint(Relative({ 1.0, 1.5, 1.0 })) };
+	ASSERT_EQ(1, q.numberOfEdges);
+	EXPECT_NE(id, sT.getEdgeId(Cell({ 1, 1, 1 }), q.edges[0]));
+}
+
+TEST_F(SnapperToolsTest, edgeCandidates_onCellFace)
+{
+	SnapperTools sT(buildUnitGrid());
+
+	// Point inside the z-face of cell (1,1,1): only edges on that face.
+	auto p{ sT.findClosestSolverPoint(Relative({ 1.2, 1.1, 1.0 })) };
+	ASSERT_EQ(3, p.numberOfEdges);
+	std::size_t candidates = 0;
+	for (std::size_t e = 0; e < p.numberOfEdges; e++) {
+		if (sT.isEdgeCandidate(p.edges[e], Relative({ 1.2, 1.1, 1.0 }))) {
+			candidates++;
+		}
+	}
+	EXPECT_EQ(2, candidates);
+}
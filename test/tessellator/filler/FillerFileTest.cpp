@@ -0,0 +1,161 @@
+#include "gtest/gtest.h"
+
+#include "filler/FillerFile.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+using namespace meshlib;
+using namespace tessellator;
+using namespace filler;
+using namespace fillerFile;
+
+class FillerFileTest : public ::testing::Test {
+protected:
+	static std::string buildTemporaryPath(const std::string& name)
+	{
+		return (std::filesystem::temp_directory_path() / name).string();
+	}
+
+	static FillingRaster buildRaster()
+	{
+		FillingRaster::States states{
+			{ { 1, 1 }, FillingState{ FillingType::Partial } },
+			{ { 1, 2 }, FillingState{ 3 } },
+			{ { 2, 1 }, FillingState{ 3 } },
+			{ { 2, 2 }, FillingState{ FillingType::Partial } },
+		};
+		return FillingRaster{ states };
+	}
+
+	static std::vector<Writer::Face> buildFaces()
+	{
+		Writer::Face first{ { 1, 1 } };
+		first.triangles.push_back({ { 1.0, 1.0, 2.0, 1.0, 1.0, 2.0 }, 3 });
+		first.fractions.push_back({ 3, 0, 0.5 });
+		Writer::Face second{ { 2, 2 } };
+		second.segments.push_back({ { 2.0, 2.5, 3.0, 2.5 }, -1 });
+		return { first, second };
+	}
+
+	static void writeFile(const std::string& path)
+	{
+		Writer w;
+		w.addSlice(Z, FillingRaster{}, {});
+		w.addSlice(Z, buildRaster(), buildFaces());
+		w.addLine(Z, { 0, 1 }, { { { 0.0, 0.5 }, 3 } });
+		w.addLine(Z, { 2, 0 }, { { { 0.5, 1.0 }, 3 }, { { 1.0, 2.0 }, 4 } });
+		w.write(path);
+	}
+
+	template<typename T>
+	static void overwrite(const std::string& path, const std::uint64_t& offset, const T& value)
+	{
+		std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+		f.seekp(offset);
+		f.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	static Header readHeader(const std::string& path)
+	{
+		Header h;
+		std::ifstream f(path, std::ios::binary);
+		f.read(reinterpret_cast<char*>(&h), sizeof(Header));
+		return h;
+	}
+};
+
+TEST_F(FillerFileTest, write_and_map)
+{
+	const auto path{ buildTemporaryPath("FillerFileTest_write_and_map.bin") };
+	writeFile(path);
+
+	{
+		MappedFile f{ path };
+		EXPECT_EQ(0, f.numberOfSlices(X));
+		ASSERT_EQ(2, f.numberOfSlices(Z));
+
+		EXPECT_TRUE(f.getRaster(Z, 0).getFillingState({ 1, 1 }).empty());
+		EXPECT_TRUE(f.getRaster(Z, 2).getFillingState({ 1, 1 }).empty());
+		EXPECT_TRUE(f.getRaster(X, 1).getFillingState({ 1, 1 }).empty());
+		auto raster{ f.getRaster(Z, 1) };
+		EXPECT_TRUE(raster.getFillingState({ 1, 1 }).partial());
+		EXPECT_EQ(3, raster.getFillingState({ 1, 2 }).getPriority());
+		EXPECT_EQ(3, raster.getFillingState({ 2, 1 }).getPriority());
+		EXPECT_TRUE(raster.getFillingState({ 2, 3 }).empty());
+
+		EXPECT_EQ(nullptr, f.findFace(Z, 1, { 1, 2 }));
+		EXPECT_EQ(nullptr, f.findFace(Z, 0, { 1, 1 }));
+		const auto* first{ f.findFace(Z, 1, { 1, 1 }) };
+		ASSERT_NE(nullptr, first);
+		ASSERT_EQ(1, f.getTriangles(*first).size());
+		EXPECT_EQ(3, f.getTriangles(*first)[0].priority);
+		EXPECT_EQ(2.0, f.getTriangles(*first)[0].coordinates[2]);
+		EXPECT_TRUE(f.getSegments(*first).empty());
+		ASSERT_EQ(1, f.getFractions(*first).size());
+		EXPECT_EQ(0.5, f.getFractions(*first)[0].value);
+
+		const auto* second{ f.findFace(Z, 1, { 2, 2 }) };
+		ASSERT_NE(nullptr, second);
+		EXPECT_TRUE(f.getTriangles(*second).empty());
+		ASSERT_EQ(1, f.getSegments(*second).size());
+		EXPECT_EQ(-1, f.getSegments(*second)[0].priority);
+
+		EXPECT_EQ(nullptr, f.findLine(Z, { 1, 1 }));
+		EXPECT_EQ(nullptr, f.findLine(Y, { 0, 1 }));
+		const auto* line{ f.findLine(Z, { 2, 0 }) };
+		ASSERT_NE(nullptr, line);
+		ASSERT_EQ(2, f.getSegments(*line).size());
+		EXPECT_EQ(4, f.getSegments(*line)[1].priority);
+	}
+	std::filesystem::remove(path);
+}
+
+TEST_F(FillerFileTest, invalid_file_throws)
+{
+	const auto path{ buildTemporaryPath("FillerFileTest_invalid_file_throws.bin") };
+	{
+		std::ofstream out(path, std::ios::binary);
+		out << "This is not a filler file, but it is long enough to hold a header. "
+			<< "This is not a filler file, but it is long enough to hold a header. "
+			<< "This is not a filler file, but it is long enough to hold a header. "
+			<< "This is not a filler file, but it is long enough to hold a header. ";
+	}
+	EXPECT_THROW(MappedFile{ path }, std::runtime_error);
+	std::filesystem::remove(path);
+}
+
+TEST_F(FillerFileTest, corrupt_ranges_throw)
+{
+	const auto path{ buildTemporaryPath("FillerFileTest_corrupt_ranges_throw.bin") };
+	const auto triangles{ offsetof(Header, sections) + (std::size_t)Section::Triangles * sizeof(SectionRecord) };
+	const auto lines{ offsetof(Header, lines) + Z * sizeof(Range) };
+
+	writeFile(path);
+	EXPECT_NO_THROW(MappedFile{ path });
+
+	// Number of records overflowing the section size.
+	overwrite(path, triangles + offsetof(SectionRecord, count), std::numeric_limits<std::uint64_t>::max());
+	EXPECT_THROW(MappedFile{ path }, std::runtime_error);
+
+	// Range of a face out of the triangles section.
+	writeFile(path);
+	const auto header{ readHeader(path) };
+	const auto faceRanges{ header.sections[(std::size_t)Section::Faces].offset + offsetof(FaceRecord, triangles) };
+	overwrite(path, faceRanges + offsetof(Range, end), std::uint64_t(1000));
+	EXPECT_THROW(MappedFile{ path }, std::runtime_error);
+
+	// Lines of an axis out of the lines section.
+	writeFile(path);
+	overwrite(path, lines + offsetof(Range, end), std::uint64_t(3));
+	EXPECT_THROW(MappedFile{ path }, std::runtime_error);
+
+	// Row begins out of the runs of the slice.
+	writeFile(path);
+	overwrite(path, header.sections[(std::size_t)Section::RowBegins].offset, std::uint64_t(1000));
+	EXPECT_THROW(MappedFile{ path }, std::runtime_error);
+
+	std::filesystem::remove(path);
+}
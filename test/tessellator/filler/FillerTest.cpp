@@ -4,6 +4,8 @@
 #include "filler/Filler.h"
 #include "Slicer.h"
 
+#include <atomic>
+
 using namespace meshlib;
 using namespace tessellator;
 using namespace filler;
@@ -159,6 +161,23 @@ public:
         }
         return true;
     }
+
+    // Surfaces built from row sets may split their boundaries at other
+    // vertices, so they are compared as regions.
+    static void expectSameFaceFilling(const FaceFilling& expected, const FaceFilling& ff)
+    {
+        EXPECT_EQ(expected.lins, ff.lins);
+        ASSERT_EQ(expected.tris.size(), ff.tris.size());
+        for (const auto& [pr, surfaces] : expected.tris) {
+            ASSERT_EQ(1, ff.tris.count(pr));
+            auto missing{ surfaces };
+            missing.difference(ff.tris.at(pr));
+            auto extra{ ff.tris.at(pr) };
+            extra.difference(surfaces);
+            EXPECT_TRUE(missing.isEmpty());
+            EXPECT_TRUE(extra.isEmpty());
+        }
+    }
 };
 
 TEST_F(FillerTest, tet_stepSize1)
@@ -342,6 +361,21 @@ TEST_F(FillerTest, planeXY_mesh_filling)
     EXPECT_EQ(0, mF.countLines());
 }
 
+TEST_F(FillerTest, planeXY_mesh_filling_shares_vertices)
+{
+    Filler f{ Slicer{ buildPlaneXYMesh(1.0) }.getMesh() };
+
+    auto mF{ f.getMeshFilling() };
+
+    ASSERT_EQ(2, mF.countTriangles());
+    EXPECT_EQ(4, mF.coordinates.size());
+    for (const auto& e : mF.groups[0].elements) {
+        for (const auto& v : e.vertices) {
+            EXPECT_LT(v, mF.coordinates.size());
+        }
+    }
+}
+
 TEST_F(FillerTest, planeXY_mesh_filling_2)
 {
     auto m{ buildPlaneXYMesh(1.0) };
@@ -880,3 +914,236 @@ TEST_F(FillerTest, fillingDetection_cube)
     }
 }
 
+TEST_F(FillerTest, fillingStates_of_slices_match_single_queries)
+{
+    auto m{ Slicer{ buildTetSurfaceMesh(0.5) }.getMesh() };
+    Filler f{ m };
+    for (const auto& x : { X, Y, Z }) {
+        const auto states{ f.getFillingStates(x) };
+        ASSERT_EQ(m.grid[x].size(), states.size());
+        const CellDir n{ (CellDir)m.grid[(x + 2) % 3].size() - 1 };
+        for (CellDir k{ 0 }; k < (CellDir)states.size(); ++k) {
+            for (std::size_t face{ 0 }; face < states[k].size(); ++face) {
+                Cell c;
+                c[x] = k;
+                c[(x + 1) % 3] = CellDir(face) / n;
+                c[(x + 2) % 3] = CellDir(face) % n;
+                EXPECT_EQ(f.getFillingState({ c, x }).type, states[k][face].type);
+            }
+        }
+    }
+}
+
+TEST_F(FillerTest, visitPartialFaces_visits_each_partial_face_once)
+{
+    auto m{ Slicer{ buildTetSurfaceMesh(0.5) }.getMesh() };
+    Filler f{ m };
+
+    std::mutex visitedMutex;
+    std::vector<CellIndex> visited;
+    f.visitPartialFaces(
+        [&](const CellIndex& c, const FaceFilling& ff) {
+            expectSameFaceFilling(f.getFaceFilling(c), ff);
+            std::lock_guard<std::mutex> lock(visitedMutex);
+            visited.push_back(c);
+        }
+    );
+
+    std::size_t partials{ 0 };
+    for (const auto& x : { X, Y, Z }) {
+        for (const auto& states : f.getFillingStates(x)) {
+            partials += std::count_if(states.begin(), states.end(),
+                [](const auto& s) { return s.partial(); });
+        }
+    }
+    EXPECT_EQ(partials, visited.size());
+    for (const auto& c : visited) {
+        EXPECT_TRUE(f.getFillingState(c).partial());
+    }
+}
+
+TEST_F(FillerTest, visitPartialFaces_rows_of_several_faces)
+{
+    auto m{ Slicer{ buildTetSurfaceMesh(0.25) }.getMesh() };
+    Filler f{ m };
+
+    std::atomic<std::size_t> visited{ 0 };
+    f.visitPartialFaces(
+        [&](const CellIndex& c, const FaceFilling& ff) {
+            expectSameFaceFilling(f.getFaceFilling(c), ff);
+            visited++;
+        }
+    );
+    EXPECT_LT(0, visited);
+}
+
+TEST_F(FillerTest, faceFilling_cache_hits_and_misses)
+{
+    Filler f{ Slicer{ buildTetSurfaceMesh(0.5) }.getMesh() };
+    const CellIndex c{ Cell({ 1, 0, 0 }), Z };
+    const auto expected{ f.getFaceFilling(c) };
+    EXPECT_EQ(0, f.getFaceFillingCacheStats().misses);
+
+    f.setFaceFillingCacheBudget(1 << 20);
+    EXPECT_EQ(expected, f.getFaceFilling(c));
+    EXPECT_EQ(expected, f.getFaceFilling(c));
+    EXPECT_EQ(1, f.getFaceFillingCacheStats().misses);
+    EXPECT_EQ(1, f.getFaceFillingCacheStats().hits);
+
+    f.setFaceFillingCacheBudget(1);
+    EXPECT_EQ(expected, f.getFaceFilling(c));
+    EXPECT_EQ(expected, f.getFaceFilling(c));
+    EXPECT_EQ(0, f.getFaceFillingCacheStats().hits);
+}
+
+TEST_F(FillerTest, areaFractions_match_face_fillings)
+{
+    auto m{ Slicer{ buildTetSurfaceMesh(0.5) }.getMesh() };
+    Filler f{ m };
+
+    auto full{ f.getAreaFractions({ Cell({ 0, 0, 0 }), Z }) };
+    ASSERT_EQ(1, full.size());
+    EXPECT_EQ(1.0, full.begin()->second);
+
+    EXPECT_TRUE(f.getAreaFractions({ Cell({ 1, 1, 0 }), Z }).empty());
+
+    f.visitPartialFaces(
+        [&](const CellIndex& c, const FaceFilling& ff) {
+            const auto fractions{ f.getAreaFractions(c) };
+            for (const auto& [pr, pS] : ff.tris) {
+                ASSERT_EQ(1, fractions.count(pr));
+                EXPECT_NEAR(CGAL::to_double(pS.area()), fractions.at(pr), 1e-9);
+            }
+        }
+    );
+}
+
+TEST_F(FillerTest, cube_edge_filling_on_grid_lines)
+{
+    // Cube faces lie on grid planes, so its edges are covered grid lines.
+    Filler f{ Slicer{ buildCubeSurfaceMesh(1.0) }.getMesh() };
+
+    for (const auto& x : { X, Y, Z }) {
+        for (const auto& c : { Cell({ 1, 1, 1 }), Cell({ 1, 2, 2 }), Cell({ 2, 1, 2 }), Cell({ 2, 2, 1 }) }) {
+            Cell edge{ c };
+            edge[x] = 1;
+            const CellIndex idx{ edge, x };
+            auto ef{ f.getEdgeFilling(idx) };
+            ASSERT_EQ(1, ef.lins.count(0));
+            ASSERT_EQ(1, ef.lins[0].size());
+            EXPECT_EQ(1.0, ef.lins[0][0][0]);
+            EXPECT_EQ(2.0, ef.lins[0][0][1]);
+            EXPECT_EQ(Fractions({ { 0, 1.0 } }), f.getLengthFractions(idx));
+        }
+
+        Cell outside{ Cell({ 1, 1, 1 }) };
+        outside[x] = 0;
+        EXPECT_EQ(0, countLins(f.getEdgeFilling({ outside, x })));
+        EXPECT_TRUE(f.getLengthFractions({ outside, x }).empty());
+    }
+}
+
+TEST_F(FillerTest, edge_filling_keeps_pieces_beyond_a_gap)
+{
+    // Two squares of the same group lie on the same grid line, leaving a
+    // gap between x = 0.3 and x = 0.6.
+    Mesh m;
+    m.grid = utils::GridTools::buildCartesianGrid(0.0, 1.0, 2);
+    m.coordinates = {
+        Coordinate({ 0.0, 0.0, 0.0 }),
+        Coordinate({ 0.3, 0.0, 0.0 }),
+        Coordinate({ 0.3, 0.5, 0.0 }),
+        Coordinate({ 0.0, 0.5, 0.0 }),
+        Coordinate({ 0.6, 0.0, 0.0 }),
+        Coordinate({ 1.0, 0.0, 0.0 }),
+        Coordinate({ 1.0, 0.5, 0.0 }),
+        Coordinate({ 0.6, 0.5, 0.0 })
+    };
+    m.groups = { Group() };
+    m.groups[0].elements = {
+        Element({ 0, 1, 2 }),
+        Element({ 0, 2, 3 }),
+        Element({ 4, 5, 6 }),
+        Element({ 4, 6, 7 })
+    };
+    Filler f{ m };
+
+    const CellIndex c{ Cell({ 0, 0, 0 }), X };
+    auto ef{ f.getEdgeFilling(c) };
+    ASSERT_EQ(1, ef.lins.count(0));
+    ASSERT_EQ(2, ef.lins[0].size());
+    EXPECT_EQ(0.0, ef.lins[0][0][0]);
+    EXPECT_EQ(0.3, ef.lins[0][0][1]);
+    EXPECT_EQ(0.6, ef.lins[0][1][0]);
+    EXPECT_EQ(1.0, ef.lins[0][1][1]);
+
+    auto fractions{ f.getLengthFractions(c) };
+    ASSERT_EQ(1, fractions.count(0));
+    EXPECT_NEAR(0.7, fractions[0], 1e-12);
+}
+
+TEST_F(FillerTest, partially_aligned_surface_edge_filling)
+{
+    // A square on plane z = 0 folded into a slanted square which rises
+    // from x = 1 to x = 2. Only the aligned square covers grid lines.
+    Mesh m;
+    m.grid = utils::GridTools::buildCartesianGrid(0.0, 2.0, 3);
+    m.coordinates = {
+        Coordinate({ 0.0, 0.0, 0.0 }),
+        Coordinate({ 1.0, 0.0, 0.0 }),
+        Coordinate({ 1.0, 1.0, 0.0 }),
+        Coordinate({ 0.0, 1.0, 0.0 }),
+        Coordinate({ 2.0, 0.0, 1.0 }),
+        Coordinate({ 2.0, 1.0, 1.0 })
+    };
+    m.groups = { Group() };
+    m.groups[0].elements = {
+        Element({ 0, 1, 2 }),
+        Element({ 0, 2, 3 }),
+        Element({ 1, 4, 5 }),
+        Element({ 1, 5, 2 })
+    };
+    Filler f{ m };
+
+    for (const auto& [c, x] : std::vector<std::pair<Cell, Axis>>{
+        { Cell({ 0, 0, 0 }), X },
+        { Cell({ 0, 1, 0 }), X },
+        { Cell({ 0, 0, 0 }), Y },
+        { Cell({ 1, 0, 0 }), Y } }) {
+        const CellIndex idx{ c, x };
+        EXPECT_EQ(1, countLins(f.getEdgeFilling(idx)));
+        EXPECT_EQ(Fractions({ { 0, 1.0 } }), f.getLengthFractions(idx));
+    }
+
+    // The slanted square only touches the line at x = 1.
+    EXPECT_EQ(0, countLins(f.getEdgeFilling({ Cell({ 1, 0, 0 }), X })));
+    EXPECT_TRUE(f.getLengthFractions({ Cell({ 1, 0, 0 }), X }).empty());
+}
+
+TEST_F(FillerTest, lengthFractions_match_edge_fillings)
+{
+    auto m{ Slicer{ buildPlaneXYMesh(1.0) }.getMesh() };
+    Filler f{ m };
+    
+    for (const auto& x : { X, Y }) {
+        const CellIndex c{ Cell({ 1, 1, 1 }), x };
+        double length{ 0.0 };
+        for (const auto& [pr, segs] : f.getEdgeFilling(c).lins) {
+            for (const auto& s : segs) {
+                length += std::abs(s[1] - s[0]);
+            }
+        }
+        double fraction{ 0.0 };
+        for (const auto& [pr, l] : f.getLengthFractions(c)) {
+            fraction += l;
+        }
+        EXPECT_GT(fraction, 0.0);
+        EXPECT_DOUBLE_EQ(length, fraction);
+
+        std::vector<double> line;
+        f.getLengthFractions(line, x, c.getArrayIndex(), 0);
+        ASSERT_EQ(m.grid[x].size() - 1, line.size());
+        EXPECT_DOUBLE_EQ(fraction, line[1]);
+    }
+    EXPECT_TRUE(f.getLengthFractions({ Cell({ 1, 1, 2 }), X }).empty());
+}
@@ -3,6 +3,9 @@
 
 #include "filler/FillerTools.h"
 
+#include <functional>
+#include <set>
+
 using namespace meshlib;
 using namespace tessellator;
 using namespace filler;
@@ -19,6 +22,57 @@ public:
         }
         return r;
     }
+
+    // Reference scan testing every face of the bounding box.
+    static std::set<ArrayIndex> bruteForceFaceIntersections(
+        const CGAL::Bbox_2& bbox,
+        const std::function<bool(const ArrayIndex&)>& isCrossed)
+    {
+        std::set<ArrayIndex> r;
+        for (auto i{ (CellDir)std::floor(bbox.xmin()) }; i < (CellDir)std::ceil(bbox.xmax()); ++i) {
+            for (auto j{ (CellDir)std::floor(bbox.ymin()) }; j < (CellDir)std::ceil(bbox.ymax()); ++j) {
+                if (isCrossed({ i, j })) {
+                    r.insert({ i, j });
+                }
+            }
+        }
+        return r;
+    }
+
+    static void expectSameAsBruteForce(const Triangle2& t)
+    {
+        auto fast{ faceIntersections(t) };
+        std::set<ArrayIndex> r{ fast.begin(), fast.end() };
+        EXPECT_EQ(fast.size(), r.size());
+        EXPECT_EQ(
+            bruteForceFaceIntersections(t.bbox(),
+                [&](const ArrayIndex& idx) { return isCellCrossedByTriangle(t, idx); }),
+            r);
+    }
+
+    static void expectSameAsBruteForce(const Polylines2& pls)
+    {
+        CGAL::Bbox_2 bbox;
+        for (const auto& pl : pls) {
+            bbox += CGAL::bbox_2(pl.begin(), pl.end());
+        }
+        auto fast{ faceIntersections(pls) };
+        std::set<ArrayIndex> r{ fast.begin(), fast.end() };
+        EXPECT_EQ(fast.size(), r.size());
+        EXPECT_EQ(
+            bruteForceFaceIntersections(bbox,
+                [&](const ArrayIndex& idx) {
+                    for (const auto& pl : pls) {
+                        for (auto it{ pl.begin() }; std::next(it) != pl.end(); ++it) {
+                            if (isCellCrossedBySegment(Segment2{ *it, *std::next(it) }, idx)) {
+                                return true;
+                            }
+                        }
+                    }
+                    return false;
+                }),
+            r);
+    }
 };
 
 TEST_F(FillerToolsTest, build_polygons_from_relatively_simple_triangulation)
@@ -78,6 +132,57 @@ TEST_F(FillerToolsTest, buildCDT_from_polygon)
     EXPECT_EQ(1, cdt.size());
 }
 
+TEST_F(FillerToolsTest, buildTriangleSoup_shares_vertices)
+{
+    Polygon outer;
+    outer.push_back({ 0.0, 0.0 });
+    outer.push_back({ 3.0, 0.0 });
+    outer.push_back({ 3.0, 3.0 });
+    outer.push_back({ 0.0, 3.0 });
+    Polygon hole;
+    hole.push_back({ 1.0, 1.0 });
+    hole.push_back({ 2.0, 1.0 });
+    hole.push_back({ 2.0, 2.0 });
+    hole.push_back({ 1.0, 2.0 });
+
+    HPolygonSet pS{ outer };
+    pS.difference(hole);
+    auto soup{ buildTriangleSoup(pS) };
+
+    EXPECT_EQ(8, soup.vertices.size());
+    ASSERT_EQ(8, soup.size());
+    double area{ 0.0 };
+    for (TriangleSoup::Index t{ 0 }; t < soup.size(); ++t) {
+        area += soup.getTriangle(t).area();
+    }
+    EXPECT_DOUBLE_EQ(8.0, area);
+}
+
+TEST_F(FillerToolsTest, faceIntersections_triangles_match_brute_force)
+{
+    // Large, thin, slanted and with vertices on grid lines and corners.
+    expectSameAsBruteForce(Triangle2{ { 0.5, 0.5 }, { 7.5, 1.5 }, { 3.2, 6.8 } });
+    expectSameAsBruteForce(Triangle2{ { 0.1, 0.1 }, { 9.9, 0.3 }, { 9.9, 0.35 } });
+    expectSameAsBruteForce(Triangle2{ { 0.2, 0.1 }, { 0.3, 8.7 }, { 0.25, 8.9 } });
+    expectSameAsBruteForce(Triangle2{ { -2.3, 1.7 }, { 4.1, -3.6 }, { 5.9, 4.4 } });
+    expectSameAsBruteForce(Triangle2{ { 1.0, 1.0 }, { 5.0, 2.0 }, { 2.0, 6.0 } });
+    expectSameAsBruteForce(Triangle2{ { 0.0, 0.0 }, { 4.0, 0.0 }, { 0.0, 4.0 } });
+    expectSameAsBruteForce(Triangle2{ { 1.0, 0.5 }, { 3.0, 0.5 }, { 2.0, 3.0 } });
+}
+
+TEST_F(FillerToolsTest, faceIntersections_polylines_match_brute_force)
+{
+    // Slanted, through grid corners and partly lying on grid lines.
+    expectSameAsBruteForce(Polylines2{ { { 0.5, 0.5 }, { 7.5, 3.2 }, { 2.1, 6.9 } } });
+    expectSameAsBruteForce(Polylines2{ { { 0.0, 0.0 }, { 3.0, 3.0 }, { 6.0, 1.5 } } });
+    expectSameAsBruteForce(Polylines2{ { { 1.0, 0.5 }, { 1.0, 2.5 }, { 2.7, 3.2 } } });
+    expectSameAsBruteForce(Polylines2{ { { 0.5, 2.0 }, { 4.5, 2.0 }, { 4.5, 0.2 }, { 0.5, 0.2 } } });
+    expectSameAsBruteForce(Polylines2{
+        { { -1.5, 0.3 }, { 2.2, 0.4 } },
+        { { 3.0, -2.0 }, { 3.0, 4.0 }, { 0.1, 4.0 } }
+    });
+}
+
 TEST_F(FillerToolsTest, intersectionTriWithCell)
 {
     EXPECT_TRUE(
@@ -0,0 +1,135 @@
+#include "gtest/gtest.h"
+
+#include "filler/FillingRaster.h"
+
+using namespace meshlib;
+using namespace tessellator;
+using namespace filler;
+
+class FillingRasterTest : public ::testing::Test {
+protected:
+	static FillingRaster buildSquareRaster()
+	{
+		// 4x4 square of priority 1 with a partial contour around it.
+		FillingRaster::States states;
+		for (CellDir i{ 0 }; i < 6; ++i) {
+			for (CellDir j{ 0 }; j < 6; ++j) {
+				if (i == 0 || i == 5 || j == 0 || j == 5) {
+					states.push_back({ { i, j }, FillingState{ FillingType::Partial } });
+				}
+				else {
+					states.push_back({ { i, j }, FillingState{ 1 } });
+				}
+			}
+		}
+		return FillingRaster{ states };
+	}
+};
+
+TEST_F(FillingRasterTest, empty_raster)
+{
+	FillingRaster r;
+	EXPECT_TRUE(r.getFillingState({ 0, 0 }).empty());
+	EXPECT_EQ(0, r.numberOfRuns());
+}
+
+TEST_F(FillingRasterTest, states_of_square)
+{
+	auto r{ buildSquareRaster() };
+
+	EXPECT_TRUE(r.getFillingState({ 0, 3 }).partial());
+	EXPECT_TRUE(r.getFillingState({ 3, 0 }).partial());
+	EXPECT_TRUE(r.getFillingState({ 3, 5 }).partial());
+	ASSERT_TRUE(r.getFillingState({ 3, 3 }).full());
+	EXPECT_EQ(1, r.getFillingState({ 3, 3 }).getPriority());
+
+	EXPECT_TRUE(r.getFillingState({ -1, 3 }).empty());
+	EXPECT_TRUE(r.getFillingState({ 6, 3 }).empty());
+	EXPECT_TRUE(r.getFillingState({ 3, -1 }).empty());
+	EXPECT_TRUE(r.getFillingState({ 3, 6 }).empty());
+}
+
+TEST_F(FillingRasterTest, rows_are_run_length_encoded)
+{
+	auto r{ buildSquareRaster() };
+
+	// Two rows with a single run, four rows with three runs.
+	EXPECT_EQ(2 + 4 * 3, r.numberOfRuns());
+}
+
+TEST_F(FillingRasterTest, gaps_and_priorities)
+{
+	FillingRaster::States states{
+		{ { 2, 7 }, FillingState{ -3 } },
+		{ { 2, 4 }, FillingState{ 5 } },
+		{ { 2, 5 }, FillingState{ 5 } },
+		{ { 4, 1 }, FillingState{ FillingType::Empty } },
+		{ { 5, 1 }, FillingState{ -3 } },
+	};
+	FillingRaster r{ states };
+
+	EXPECT_EQ(5, r.getFillingState({ 2, 4 }).getPriority());
+	EXPECT_EQ(5, r.getFillingState({ 2, 5 }).getPriority());
+	EXPECT_TRUE(r.getFillingState({ 2, 6 }).empty());
+	EXPECT_EQ(-3, r.getFillingState({ 2, 7 }).getPriority());
+	EXPECT_TRUE(r.getFillingState({ 3, 1 }).empty());
+	EXPECT_TRUE(r.getFillingState({ 4, 1 }).empty());
+	EXPECT_EQ(-3, r.getFillingState({ 5, 1 }).getPriority());
+	EXPECT_EQ(3, r.numberOfRuns());
+}
+
+TEST_F(FillingRasterTest, fill_matches_single_queries)
+{
+	auto r{ buildSquareRaster() };
+
+	const ArrayIndex size{ 5, 8 };
+	std::vector<FillingState> states;
+	r.fill(states, size);
+	ASSERT_EQ(40, states.size());
+	for (CellDir i{ 0 }; i < size[0]; ++i) {
+		for (CellDir j{ 0 }; j < size[1]; ++j) {
+			const auto expected{ r.getFillingState({ i, j }) };
+			const auto& s{ states[i * size[1] + j] };
+			ASSERT_EQ(expected.type, s.type);
+			if (s.full()) {
+				EXPECT_EQ(expected.getPriority(), s.getPriority());
+			}
+		}
+	}
+}
+
+TEST_F(FillingRasterTest, rows_of_partial_faces)
+{
+	auto r{ buildSquareRaster() };
+
+	auto rows{ r.getRows(FillingType::Partial) };
+	ASSERT_EQ(6, rows.size());
+	EXPECT_EQ(6, rows.front().size());
+	EXPECT_EQ(2, rows[1].size());
+	EXPECT_EQ(ArrayIndex({ 1, 0 }), rows[1][0]);
+	EXPECT_EQ(ArrayIndex({ 1, 5 }), rows[1][1]);
+
+	EXPECT_EQ(4, r.getRows(FillingType::Full).size());
+	EXPECT_TRUE(r.getRows(FillingType::Empty).empty());
+}
+
+TEST_F(FillingRasterTest, overlapping_spans_keep_first_given)
+{
+	FillingRaster::Spans spans{
+		{ 1, 3, 4, FillingState{ FillingType::Partial } },
+		{ 1, 0, 6, FillingState{ 2 } },
+		{ 1, 5, 9, FillingState{ 7 } },
+		{ 1, 2, 3, FillingState{ 2 } },
+		{ 3, 0, 2, FillingState{ 7 } },
+	};
+	FillingRaster r{ spans };
+
+	EXPECT_EQ(2, r.getFillingState({ 1, 0 }).getPriority());
+	EXPECT_TRUE(r.getFillingState({ 1, 3 }).partial());
+	EXPECT_EQ(2, r.getFillingState({ 1, 5 }).getPriority());
+	EXPECT_EQ(7, r.getFillingState({ 1, 6 }).getPriority());
+	EXPECT_TRUE(r.getFillingState({ 1, 9 }).empty());
+	EXPECT_TRUE(r.getFillingState({ 2, 0 }).empty());
+	EXPECT_EQ(7, r.getFillingState({ 3, 1 }).getPriority());
+	EXPECT_EQ(4 + 1, r.numberOfRuns());
+}
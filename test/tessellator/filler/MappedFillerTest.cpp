@@ -0,0 +1,90 @@
+#include "gtest/gtest.h"
+#include "MeshFixtures.h"
+
+#include "filler/Filler.h"
+#include "filler/MappedFiller.h"
+#include "Slicer.h"
+
+#include <filesystem>
+
+using namespace meshlib;
+using namespace tessellator;
+using namespace filler;
+using namespace meshFixtures;
+
+class MappedFillerTest : public ::testing::Test {
+protected:
+	static std::string buildTemporaryPath(const std::string& name)
+	{
+		return (std::filesystem::temp_directory_path() / name).string();
+	}
+
+	static void expectSameQueries(const Mesh& m, const std::string& name)
+	{
+		expectSameQueries(Filler{ m }, m.grid, name);
+	}
+
+	static void expectSameQueries(const Filler& f, const Grid& grid, const std::string& name)
+	{
+		const auto path{ buildTemporaryPath(name) };
+		f.save(path);
+		{
+			MappedFiller mf{ path };
+			for (const auto& x : { X, Y, Z }) {
+				for (CellDir i{ -1 }; i <= (CellDir)grid[X].size(); ++i) {
+					for (CellDir j{ -1 }; j <= (CellDir)grid[Y].size(); ++j) {
+						for (CellDir k{ -1 }; k <= (CellDir)grid[Z].size(); ++k) {
+							const CellIndex c{ Cell({ i, j, k }), x };
+							const auto state{ f.getFillingState(c) };
+							ASSERT_EQ(state.type, mf.getFillingState(c).type);
+							if (state.full()) {
+								EXPECT_EQ(state.getPriority(), mf.getFillingState(c).getPriority());
+							}
+							EXPECT_EQ(f.getFaceFilling(c), mf.getFaceFilling(c));
+							EXPECT_EQ(f.getEdgeFilling(c), mf.getEdgeFilling(c));
+							EXPECT_EQ(f.getAreaFractions(c), mf.getAreaFractions(c));
+						}
+					}
+				}
+			}
+		}
+		std::filesystem::remove(path);
+	}
+};
+
+TEST_F(MappedFillerTest, tet_surface)
+{
+	expectSameQueries(
+		Slicer{ buildTetSurfaceMesh(0.5) }.getMesh(),
+		"MappedFillerTest_tet_surface.bin");
+}
+
+TEST_F(MappedFillerTest, two_materials_plane)
+{
+	expectSameQueries(
+		Slicer{ buildPlaneXYTwoMaterialsMesh(1.0) }.getMesh(),
+		"MappedFillerTest_two_materials_plane.bin");
+}
+
+TEST_F(MappedFillerTest, surface_plane_on_grid_lines)
+{
+	// Plane edges lie on grid lines of the slices normal to x and y, so
+	// they cross faces which are not partial.
+	const auto m{ Slicer{ buildPlaneXYMesh(1.0) }.getMesh() };
+	expectSameQueries(
+		Filler{ Mesh(), m }, m.grid,
+		"MappedFillerTest_surface_plane_on_grid_lines.bin");
+}
+
+TEST_F(MappedFillerTest, surface_cube_on_grid_lines)
+{
+	const auto m{ Slicer{ buildCubeSurfaceMesh(1.0) }.getMesh() };
+	expectSameQueries(
+		Filler{ Mesh(), m }, m.grid,
+		"MappedFillerTest_surface_cube_on_grid_lines.bin");
+}
+
+TEST_F(MappedFillerTest, missing_file_throws)
+{
+	EXPECT_ANY_THROW(MappedFiller{ buildTemporaryPath("MappedFillerTest_missing_file.bin") });
+}
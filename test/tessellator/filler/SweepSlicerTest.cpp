@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+#include "MeshFixtures.h"
+
+#include "filler/SweepSlicer.h"
+
+using namespace meshlib;
+using namespace tessellator;
+using namespace filler;
+using namespace meshFixtures;
+
+class SweepSlicerTest : public ::testing::Test {
+protected:
+	static Mesh buildCubeInRelativeCoordinates()
+	{
+		Mesh m{ buildCubeSurfaceMesh(1.0) };
+		m.grid = utils::GridTools::buildCartesianGrid(0.0, 3.0, 4);
+		for (auto& c : m.coordinates) {
+			c = c * 2.0 + Coordinate({ 0.5, 0.5, 0.5 });
+		}
+		return m;
+	}
+
+	static double getSignedArea(const Coordinates& pl, const Axis& x)
+	{
+		const Axis u{ (x + 1) % 3 };
+		const Axis v{ (x + 2) % 3 };
+		double res{ 0.0 };
+		for (std::size_t i{ 0 }; i + 1 < pl.size(); ++i) {
+			res += pl[i][u] * pl[i + 1][v] - pl[i + 1][u] * pl[i][v];
+		}
+		return res / 2.0;
+	}
+};
+
+TEST_F(SweepSlicerTest, cube_gives_closed_ccw_contours)
+{
+	auto polylines{ SweepSlicer{ buildCubeInRelativeCoordinates() }.getPolylines() };
+
+	for (const auto& x : { X, Y, Z }) {
+		ASSERT_EQ(2, polylines[x].size());
+		for (const auto& h : { 1, 2 }) {
+			ASSERT_EQ(1, polylines[x].count(h));
+			const auto& pls{ polylines[x].at(h) };
+			ASSERT_EQ(1, pls.size());
+			const auto& pl{ pls.front() };
+			EXPECT_EQ(pl.front(), pl.back());
+			for (const auto& c : pl) {
+				EXPECT_EQ(h, c[x]);
+			}
+			EXPECT_DOUBLE_EQ(4.0, getSignedArea(pl, x));
+		}
+	}
+}
+
+TEST_F(SweepSlicerTest, triangle_gives_open_polylines)
+{
+	Mesh m;
+	m.grid = utils::GridTools::buildCartesianGrid(0.0, 3.0, 4);
+	m.coordinates = {
+		Coordinate({ 0.5, 0.5, 1.5 }),
+		Coordinate({ 2.5, 0.5, 1.5 }),
+		Coordinate({ 0.5, 2.0, 1.5 })
+	};
+	m.groups = { Group() };
+	m.groups[0].elements = { Element({ 0, 1, 2 }) };
+
+	auto polylines{ SweepSlicer{ m }.getPolylines() };
+
+	EXPECT_TRUE(polylines[Z].empty());
+
+	ASSERT_EQ(2, polylines[X].size());
+	for (const auto& [h, pls] : polylines[X]) {
+		ASSERT_EQ(1, pls.size());
+		EXPECT_EQ(2, pls.front().size());
+		EXPECT_NE(pls.front().front(), pls.front().back());
+	}
+
+	// The third vertex only touches plane y = 2.
+	ASSERT_EQ(1, polylines[Y].size());
+	EXPECT_EQ(1, polylines[Y].count(1));
+}
+
+TEST_F(SweepSlicerTest, edge_on_plane_is_sliced_once)
+{
+	Mesh m;
+	m.grid = utils::GridTools::buildCartesianGrid(0.0, 3.0, 4);
+	m.coordinates = {
+		Coordinate({ 0.5, 1.0, 0.5 }),
+		Coordinate({ 2.5, 1.0, 0.5 }),
+		Coordinate({ 1.5, 0.5, 1.5 }),
+		Coordinate({ 1.5, 1.5, 1.5 })
+	};
+	m.groups = { Group() };
+	m.groups[0].elements = {
+		Element({ 0, 1, 2 }),
+		Element({ 1, 0, 3 })
+	};
+
+	auto polylines{ SweepSlicer{ m }.getPolylines() };
+
+	ASSERT_EQ(1, polylines[Y].count(1));
+	const auto& pls{ polylines[Y].at(1) };
+	ASSERT_EQ(1, pls.size());
+	EXPECT_EQ(2, pls.front().size());
+}
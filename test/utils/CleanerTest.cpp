@@ -83,3 +83,59 @@ TEST_F(CleanerTest, removeElementsWithCondition)
 
 }
 
+
+TEST_F(CleanerTest, fuseLatticeCoords)
+{
+	Mesh m;
+	m.coordinates = {
+		Coordinate({ 0.0, 0.0, 0.0 }),
+		Coordinate({ 1.0, 0.0, 0.0 }),
+		Coordinate({ 0.0, 1.0, 0.0 }),
+		Coordinate({ 0.99999999, 0.0, 0.0 }),
+		Coordinate({ 1.0, 1.0, 0.0 })
+	};
+	m.groups = { Group() };
+	m.groups[0].elements = {
+		Element({ 0, 1, 2 }),
+		Element({ 3, 4, 2 }),
+		Element({ 1, 3, 4 })
+	};
+
+	Cleaner::fuseLatticeCoords(m, Lattice{ 4 });
+
+	ASSERT_EQ(2, m.groups[0].elements.size());
+	EXPECT_EQ(CoordinateIds({ 1, 4, 2 }), m.groups[0].elements[1].vertices);
+	EXPECT_EQ(Coordinate({ 1.0, 0.0, 0.0 }), m.coordinates[3]);
+}
+
+TEST_F(CleanerTest, pipeline_matches_separate_operations)
+{
+	auto m{ buildCubeSurfaceMesh(1.0) };
+	m.coordinates.push_back(m.coordinates[0]);
+	m.coordinates.push_back(m.coordinates[1]);
+	m.coordinates.push_back(Coordinate({ 5.0, 5.0, 5.0 }));
+	const CoordinateId last = m.coordinates.size() - 1;
+	m.groups[0].elements.push_back(Element({ last - 2, 1, 2 }));
+	m.groups[0].elements.push_back(Element({ last - 2, last - 1, 2 }));
+	m.groups[0].elements.push_back(Element({ 2, 0, 1 }));
+	m.groups[0].elements.push_back(Element({ 0, 1 }, Element::Type::Line));
+
+	auto isLine{ [](const Element& e) { return e.isLine(); } };
+
+	auto expected{ m };
+	Cleaner::removeElementsWithCondition(expected, isLine);
+	Cleaner::fuseCoords(expected);
+	Cleaner::removeRepeatedElements(expected);
+	Cleaner::cleanCoords(expected);
+
+	auto r{ m };
+	Cleaner::Pipeline()
+		.cleanCoords()
+		.removeRepeatedElements()
+		.fuseCoords()
+		.removeElementsWithCondition(isLine)
+		.apply(r);
+
+	EXPECT_EQ(expected, r);
+	EXPECT_EQ(countDifferent(r.coordinates), r.coordinates.size());
+}
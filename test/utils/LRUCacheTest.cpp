@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+
+#include "LRUCache.h"
+
+#include <string>
+
+using namespace meshlib;
+using namespace utils;
+
+class LRUCacheTest : public ::testing::Test {
+protected:
+	using Cache = LRUCache<int, std::string>;
+
+	static std::size_t stringSize(const std::string& s)
+	{
+		return s.size();
+	}
+};
+
+TEST_F(LRUCacheTest, hits_and_misses)
+{
+	Cache c{ 10, stringSize };
+
+	EXPECT_FALSE(c.find(1));
+	c.insert(1, "abc");
+	auto v{ c.find(1) };
+	ASSERT_TRUE(v);
+	EXPECT_EQ("abc", *v);
+
+	EXPECT_EQ(1, c.getStats().hits);
+	EXPECT_EQ(1, c.getStats().misses);
+	EXPECT_EQ(3, c.getMemoryUsage());
+}
+
+TEST_F(LRUCacheTest, evicts_least_recently_used)
+{
+	Cache c{ 10, stringSize };
+
+	c.insert(1, "aaaa");
+	c.insert(2, "bbbb");
+	c.find(1);
+	c.insert(3, "cccc");
+
+	EXPECT_EQ(2, c.size());
+	EXPECT_TRUE(c.find(1));
+	EXPECT_FALSE(c.find(2));
+	EXPECT_TRUE(c.find(3));
+	EXPECT_EQ(8, c.getMemoryUsage());
+}
+
+TEST_F(LRUCacheTest, values_over_budget_are_not_stored)
+{
+	Cache c{ 4, stringSize };
+
+	c.insert(1, "aaa");
+	c.insert(2, "bbbbb");
+
+	EXPECT_EQ(1, c.size());
+	EXPECT_TRUE(c.find(1));
+	EXPECT_FALSE(c.find(2));
+}
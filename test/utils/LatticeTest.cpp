@@ -0,0 +1,52 @@
+#include "gtest/gtest.h"
+
+#include "Lattice.h"
+
+using namespace meshlib;
+using namespace utils;
+
+class LatticeTest : public ::testing::Test {
+};
+
+TEST_F(LatticeTest, toPoint)
+{
+	Lattice l{ 4 };
+
+	auto p{ l.toPoint(Relative({ 1.25, 0.0, 3.99999 })) };
+	EXPECT_EQ(Cell({ 1, 0, 4 }), p.cell);
+	EXPECT_EQ(2500, p.fraction[0]);
+	EXPECT_EQ(0, p.fraction[1]);
+	EXPECT_EQ(0, p.fraction[2]);
+
+	auto n{ l.toPoint(Relative({ -0.25, -1.0, 0.0 })) };
+	EXPECT_EQ(Cell({ -1, -1, 0 }), n.cell);
+	EXPECT_EQ(7500, n.fraction[0]);
+	EXPECT_EQ(0, n.fraction[1]);
+}
+
+TEST_F(LatticeTest, toRelative_matches_rounding)
+{
+	Lattice l{ 4 };
+	for (const auto& r : {
+		Relative({ 0.1, 1.0 / 3.0, 2.0 / 3.0 }),
+		Relative({ 0.09999999999999998, 12.34567, -0.00004 }) }) {
+		EXPECT_EQ(r.round(1e4), l.toRelative(l.toPoint(r)));
+	}
+}
+
+TEST_F(LatticeTest, equality_and_hash)
+{
+	Lattice l{ 4 };
+	Lattice::PointHash h;
+
+	auto p{ l.toPoint(Relative({ 0.1, 0.2, 0.3 })) };
+	auto q{ l.toPoint(Relative({ 0.09999999999999998, 0.2, 0.30000000000000004 })) };
+	EXPECT_EQ(p, q);
+	EXPECT_EQ(h(p), h(q));
+	EXPECT_FALSE(p < q);
+	EXPECT_FALSE(q < p);
+
+	auto r{ l.toPoint(Relative({ 0.1, 0.2, 0.3001 })) };
+	EXPECT_NE(p, r);
+	EXPECT_TRUE(p < r);
+}